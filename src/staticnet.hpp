@@ -27,13 +27,78 @@
 
 // External headers
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <initializer_list>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
 #include <random>
 #include <ratio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+extern "C" {
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+}
+
+/** Optional facilities of the platform, enabled on Linux unless defined beforehand (to 0 to disable them):
+ *   STATICNET_MMAP Memory mappings: huge page allocations (aligned heap memory otherwise), mapped files
+ *   STATICNET_NUMA Binding of memory and threads to NUMA nodes (a single node, no binding otherwise)
+**/
+#ifndef STATICNET_MMAP
+    #ifdef __linux__
+        #define STATICNET_MMAP 1
+    #else
+        #define STATICNET_MMAP 0
+    #endif
+#endif
+#ifndef STATICNET_NUMA
+    #ifdef __linux__
+        #define STATICNET_NUMA 1
+    #else
+        #define STATICNET_NUMA 0
+    #endif
+#endif
+#if STATICNET_MMAP
+extern "C" {
+#include <sys/mman.h>
+}
+#endif
+#if STATICNET_NUMA
+extern "C" {
+#include <pthread.h>
+#include <sched.h>
+}
+#endif
+#if STATICNET_NUMA || defined(STATICNET_PROFILE)
+extern "C" {
+#include <sys/syscall.h>
+}
+#endif
+#ifdef STATICNET_PROFILE
+extern "C" {
+#include <linux/perf_event.h>
+}
+#endif
+#if defined(STATICNET_TIMING) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
 
 // ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
 
@@ -70,907 +135,7220 @@ auto const null = nullptr;
         (prop)
 #endif
 
+/** Specify that every call in a function body is to be inlined, recursively.
+**/
+#undef flatten_calls
+#ifdef __GNUC__
+    #define flatten_calls \
+        __attribute__((flatten))
+#else
+    #define flatten_calls
+#endif
+
 }
 
 // ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Declarations ▔
-// ▁ Random number generator ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▁ Memory allocation ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
 
 namespace StaticNet {
+namespace Allocator {
 
-/** Abstract randomizer.
+/** Allocation policies, all sharing the same interface:
+ *   void* allocate(size_t size); // Throw ::std::bad_alloc on failure
+ *   void  free(void* addr, size_t size);
+ * A policy instance is owned by a single holder, and may be stateful.
 **/
-class Randomizer {
+
+constexpr size_t cache_line = 64;      // Assumed cache line size, in bytes
+constexpr size_t huge_page  = 1 << 21; // Huge page size, in bytes
+
+/** Round a size up to a multiple of the given power of 2.
+ * @param size  Size to round
+ * @param align Power of 2
+ * @return Rounded size
+**/
+constexpr size_t round(size_t size, size_t align) {
+    return (size + align - 1) & ~(align - 1);
+}
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Standard heap, cache-line aligned.
+**/
+class Heap final {
 public:
-    /** Get a random number.
+    /** Allocate a memory area.
+     * @param size Size of the area, in bytes
+     * @return Area base address
     **/
-    virtual val_t get() = 0;
+    void* allocate(size_t size) {
+        void* addr;
+        if (unlikely(::posix_memalign(&addr, cache_line, size) != 0))
+            throw ::std::bad_alloc();
+        return addr;
+    }
+    /** Free a memory area.
+     * @param addr Area base address
+    **/
+    void free(void* addr, size_t) {
+        ::std::free(addr);
+    }
 };
 
-// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+/** Anonymous mappings backed by 2 MB pages, reserved (MAP_HUGETLB) if available, transparent (madvise) otherwise.
+ * Without 'STATICNET_MMAP', plain heap memory aligned on the huge page size.
+**/
+class HugePage final {
+public:
+    /** Allocate a memory area.
+     * @param size Size of the area, in bytes
+     * @return Area base address, huge page aligned
+    **/
+    void* allocate(size_t size) {
+        size_t length = round(size, huge_page);
+#if STATICNET_MMAP
+        void* addr = ::mmap(null, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (addr != MAP_FAILED)
+            return addr;
+        { // No reserved huge page, over-map to get an aligned area then hint the kernel
+            addr = ::mmap(null, length + huge_page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (unlikely(addr == MAP_FAILED))
+                throw ::std::bad_alloc();
+            uintptr_t base  = reinterpret_cast<uintptr_t>(addr);
+            uintptr_t align = round(base, huge_page);
+            if (align > base) // Trim head
+                ::munmap(addr, align - base);
+            if (base + huge_page > align) // Trim tail
+                ::munmap(reinterpret_cast<void*>(align + length), base + huge_page - align);
+            addr = reinterpret_cast<void*>(align);
+            ::madvise(addr, length, MADV_HUGEPAGE); // Best effort
+        }
+#else
+        void* addr;
+        if (unlikely(::posix_memalign(&addr, huge_page, length) != 0))
+            throw ::std::bad_alloc();
+#endif
+        return addr;
+    }
+    /** Free a memory area.
+     * @param addr Area base address
+     * @param size Size of the area, in bytes
+    **/
+    void free(void* addr, size_t size) {
+#if STATICNET_MMAP
+        ::munmap(addr, round(size, huge_page));
+#else
+        static_cast<void>(size);
+        ::std::free(addr);
+#endif
+    }
+};
 
-/** Uniform distribution randomizer.
- * @param Ratio Uniform distribution over [-ratio(), +ratio()]
+/** Memory bound to the NUMA node of the allocating thread (plain 'Base' memory without 'STATICNET_NUMA').
+ * @param Base Page-aligned allocation policy, pages must not have been touched yet
 **/
-template<class Ratio> class UniformRandomizer final: public Randomizer {
+template<class Base = HugePage> class Numa final {
 private:
-    /** Compute floating-point ratio from the ::std::ratio type "compatible" template parameter.
-     * @return Floating-point representation of the ratio
+    constexpr static int mpol_local = 4; // MPOL_LOCAL, from <linux/mempolicy.h>
+private:
+    Base base; // Underlying allocator
+public:
+    /** Allocate a memory area.
+     * @param size Size of the area, in bytes
+     * @return Area base address
     **/
-    constexpr val_t ratio() {
-        constexpr val_t ret = static_cast<val_t>(Ratio::num) / static_cast<val_t>(Ratio::den);
-        static_assert(ret > 0, "'Ratio' must be a positive value");
-        return ret;
+    void* allocate(size_t size) {
+        void* addr = base.allocate(size);
+#if STATICNET_NUMA
+        ::syscall(SYS_mbind, addr, round(size, huge_page), mpol_local, null, 0, 0); // Best effort: non-NUMA kernels return ENOSYS
+#endif
+        return addr;
     }
+    /** Free a memory area.
+     * @param addr Area base address
+     * @param size Size of the area, in bytes
+    **/
+    void free(void* addr, size_t size) {
+        base.free(addr, size);
+    }
+};
+
+/** Bump allocator, releasing everything at destruction only.
+ * @param Base  Allocation policy for the blocks
+ * @param block Minimal block size, in bytes
+**/
+template<class Base = HugePage, size_t block = (16 << 20)> class Arena final {
+    static_assert(block % huge_page == 0, "'block' must be a multiple of the huge page size");
 private:
-    ::std::random_device                    device;
-    ::std::default_random_engine            engine;
-    ::std::uniform_real_distribution<val_t> distrib;
+    Base   base;   // Underlying allocator
+    ::std::vector<::std::pair<void*, size_t>> blocks; // Allocated blocks
+    size_t cursor; // Cursor in the last block, in bytes
 public:
-    /** Constructor.
+    /** Empty arena constructor.
     **/
-    UniformRandomizer(): device(), engine(device()), distrib(-ratio(), ratio()) {}
+    Arena(): base(), blocks(), cursor(0) {}
+    /** Copy constructor (deleted).
+    **/
+    Arena(Arena const&) = delete;
+    /** Release all the blocks.
+    **/
+    ~Arena() {
+        for (auto& blk: blocks)
+            base.free(blk.first, blk.second);
+    }
 public:
-    /** Get a random number.
-     * @return A random number
+    /** Allocate a memory area.
+     * @param size Size of the area, in bytes
+     * @return Area base address, cache-line aligned
     **/
-    val_t get() {
-        return distrib(engine);
+    void* allocate(size_t size) {
+        size = round(size, cache_line);
+        if (blocks.empty() || cursor + size > blocks.back().second) { // New block needed
+            size_t length = size > block ? round(size, huge_page) : block;
+            blocks.emplace_back(base.allocate(length), length);
+            cursor = 0;
+        }
+        void* addr = static_cast<uint8_t*>(blocks.back().first) + cursor;
+        cursor += size;
+        return addr;
     }
+    /** Free a memory area (no-op).
+    **/
+    void free(void*, size_t) {}
 };
 
 }
 
-// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
-// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Random number generator ▔
-// ▁ Transfert function ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
-// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
-
-namespace StaticNet {
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
 
-/** Transfert function.
+/** Single object placed in memory obtained from an allocation policy.
+ * @param Type  Object type
+ * @param Alloc Allocation policy
 **/
-class Transfert final {
-private:
-    constexpr static val_t diff_delta = 0.01; // Delta for derivative estimation
-private:
-    nat_t  count; // Nb points - 1
-    val_t  x_min; // Min input
-    val_t  x_max; // Max input
-    val_t  delta; // Difference between max/min
-    val_t* tbase; // Points of base function (null if not initialized)
-    val_t* tdiff; // Points of derived function (= base + prec)
+template<class Type, class Alloc = Allocator::Heap> class Allocated final {
 private:
-    /** Function type selector.
-    **/
-    enum class select { base, diff }; // Function type selector
-    /** Select a table.
-     * @param func Table to select
-     * @return Selected table
+    Alloc alloc;  // Allocator instance
+    Type* object; // Constructed object
+public:
+    /** Allocate and construct the object.
+     * @param ... Forwarded to the object constructor
     **/
-    template<select func> val_t* get() const {
-        switch (func) {
-            case select::base:
-                return tbase;
-            case select::diff:
-                return tdiff;
+    template<class... Args> Allocated(Args&&... args): alloc() {
+        void* addr = alloc.allocate(sizeof(Type));
+        try {
+            object = new(addr) Type(::std::forward<Args>(args)...);
+        } catch (...) {
+            alloc.free(addr, sizeof(Type));
+            throw;
         }
     }
-    /** Interpolate (linearly) a value through this function/its derivative/other.
-     * @param func Selected function ('base' or 'diff')
-     * @param x    Input value
-     * @return Output value
+    /** Copy constructor (deleted).
     **/
-    template<select func> val_t interpolate(val_t x) const {
-        if (unlikely(x < x_min)) {
-            return get<func>()[0];
-        } else if (unlikely(x >= x_max)) {
-            return get<func>()[count];
-        } // Else linear interpolation
-        val_t t = (x - x_min) * static_cast<val_t>(count) / delta;
-        nat_t i = static_cast<nat_t>(t); // Truncated
-        if (unlikely(i >= count)) { // Due to floating-point imprecision
-            return get<func>()[count];
-        } else {
-            val_t y_a = get<func>()[i];
-            val_t y_b = get<func>()[i + 1];
-            return y_a + (y_b - y_a) * ::std::fmod(t, val_t(1));
-        }
+    Allocated(Allocated const&) = delete;
+    /** Destroy and free the object.
+    **/
+    ~Allocated() {
+        object->~Type();
+        alloc.free(static_cast<void*>(object), sizeof(Type));
     }
 public:
-    /** Constructor.
+    /** Access the object.
+     * @return Object reference
     **/
-    Transfert(): tbase(null) {}
-    /** Destructor.
+    Type& operator*() const {
+        return *object;
+    }
+    /** Access the object members.
+     * @return Object pointer
     **/
-    ~Transfert() {
-        if (tbase)
-            ::std::free(static_cast<void*>(tbase));
+    Type* operator->() const {
+        return object;
     }
+};
+
+/** Chunked object storage, objects never move while the storage grows.
+ * @param Type  Object type
+ * @param Alloc Allocation policy for the chunks
+**/
+template<class Type, class Alloc = Allocator::Heap> class Pool final {
+private:
+    constexpr static size_t per_chunk = (sizeof(Type) < Allocator::huge_page ? Allocator::huge_page / sizeof(Type) : 1); // Objects per chunk
+private:
+    Alloc alloc; // Allocator instance
+    ::std::vector<Type*> chunks; // Allocated chunks
+    size_t count; // Number of objects
 public:
-    /** Pass parameter through the transfert function.
-     * @param x Input value
-     * @return Output value
+    /** Empty pool constructor.
     **/
-    val_t operator()(val_t x) const {
-        return interpolate<select::base>(x);
+    Pool(): alloc(), chunks(), count(0) {}
+    /** Copy constructor (deleted).
+    **/
+    Pool(Pool const&) = delete;
+    /** Destroy the objects, free the chunks.
+    **/
+    ~Pool() {
+        clear();
+        for (Type* chunk: chunks)
+            alloc.free(static_cast<void*>(chunk), per_chunk * sizeof(Type));
     }
-    /** Pass parameter through the transfert function derivative.
-     * @param x Input value
-     * @return Output value
+public:
+    /** Construct a new object at the end of the pool.
+     * @param ... Forwarded to the object constructor
+     * @return Constructed object
     **/
-    val_t diff(val_t x) const {
-        return interpolate<select::diff>(x);
+    template<class... Args> Type& emplace(Args&&... args) {
+        if (count == chunks.size() * per_chunk) // New chunk needed
+            chunks.push_back(static_cast<Type*>(alloc.allocate(per_chunk * sizeof(Type))));
+        Type* addr = chunks[count / per_chunk] + count % per_chunk;
+        new(addr) Type(::std::forward<Args>(args)...);
+        count++;
+        return *addr;
     }
-    /** (Re)set the transfert function, with optional weight correction.
-     * @param trans Transfert function
-     * @param min   Min input
-     * @param max   Max input
-     * @param prec  Amount of points
-     * @param corr  Weight correction (optional)
-     * @return True if the operation is a success, false otherwise
+    /** Destroy the last object.
     **/
-    bool set(val_t trans(val_t), val_t min, val_t max, nat_t prec) {
-        if (unlikely(min >= max || prec < 2)) // Basic checks
-            return false;
-        { // Points table allocation
-            if (tbase) // Points table freeing (if already exists)
-                ::std::free(static_cast<void*>(tbase));
-            void* addr = ::std::malloc(2 * prec * sizeof(val_t));
-            if (!addr) { // Allocation failure
-                tbase = null;
-                return false;
-            }
-            tbase = static_cast<val_t*>(addr);
-            tdiff = tbase + prec;
-        }
-        { // Tables initialization
-            x_min = min;
-            x_max = max;
-            delta = max - min;
-            count = prec - 1;
-            val_t const prec1 = static_cast<val_t>(prec - 1);
-            for (nat_t i = 0; i < prec; i++) { // Base and diff
-                val_t x = delta * static_cast<val_t>(i) / prec1 + x_min;
-                tbase[i] = trans(x);
-                tdiff[i] = (trans(x + diff_delta / 2) - trans(x - diff_delta / 2)) / diff_delta;
-            }
-        }
-        return true;
+    void pop() {
+        (*this)[--count].~Type();
+    }
+    /** Destroy all the objects, chunks are kept.
+    **/
+    void clear() {
+        while (count > 0)
+            pop();
     }
 public:
-    /** Print functions (transfert, transfert derivative, weight correction) to the given stream, to plot them.
-     * @param ostr Output stream
+    /** Access an object.
+     * @param id Object id
+     * @return Object reference
     **/
-    void print(::std::ostream& ostr) const {
-        val_t const prec1 = static_cast<val_t>(count);
-        for (nat_t i = 0; i <= count; i++) { // Base and diff
-            val_t x = delta * static_cast<val_t>(i) / prec1 + x_min;
-            ostr << x << "\t" << interpolate<select::base>(x) << "\t" << interpolate<select::diff>(x) << ::std::endl;
-        }
+    Type& operator[](size_t id) {
+        return chunks[id / per_chunk][id % per_chunk];
+    }
+    /** Find the id of an object.
+     * @param object Object of the pool
+     * @return Object id
+    **/
+    size_t index(Type const* object) const {
+        for (size_t i = 0; i < chunks.size(); i++)
+            if (object >= chunks[i] && object < chunks[i] + per_chunk)
+                return i * per_chunk + static_cast<size_t>(object - chunks[i]);
+        return count;
+    }
+    /** Return the number of objects.
+     * @return Number of objects
+    **/
+    size_t size() const {
+        return count;
     }
 };
 
 }
 
 // ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
-// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Transfert function ▔
-// ▁ Input/Output serializer ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Memory allocation ▔
+// ▁ Profiling ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
 
+#ifdef STATICNET_PROFILE
 namespace StaticNet {
-namespace Serializer {
+namespace Profiling {
 
-/** Abstract input serializer class.
+/** Hardware counter profiling, compiled in when 'STATICNET_PROFILE' is defined to a mask of the regions to profile.
+ * Counters (user space only) are read with 'perf_event_open', one event group per thread, two 'read' calls per
+ * profiled scope: regions are thus whole layers or epochs, never per-value code like the transfert function. Counts
+ * are scaled by the time the group was enabled over the time it was running, in case the PMU was multiplexed. When
+ * the counters cannot be opened (no PMU access, seccomp, non-Linux), scopes are no-ops and the report says so.
 **/
-class Input {
-public:
-    /** Load one value, in order of writing.
-     * @return Value loaded
-    **/
-    virtual val_t load() = 0;
-};
 
-/** Abstract output serializer class.
+/** Profiled regions, to be or-ed in 'STATICNET_PROFILE'.
 **/
-class Output {
+constexpr nat_t epoch         = 1 << 0; // Learning::correct, once per epoch
+constexpr nat_t layer_compute = 1 << 1; // Layer::compute
+constexpr nat_t layer_correct = 1 << 2; // Layer::correct
+
+/** Counted events.
+**/
+constexpr nat_t event_count = 5;
+static char const* const event_names[event_count] = { "cycles", "instructions", "L1D misses", "LLC misses", "branch misses" };
+
+/** Counter values.
+**/
+class Sample final {
 public:
-    /** Store one value.
-     * @param Value stored
-    **/
-    virtual void store(val_t) = 0;
+    uint64_t enabled; // Time the group was enabled, in ns
+    uint64_t running; // Time the group was actually counting, in ns (less than 'enabled' when multiplexed)
+    uint64_t values[event_count]; // Value of each event
 };
 
 // ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
 
-/** Input serializer based on a stream.
+/** Event group of the calling thread.
 **/
-class StreamInput final: public Input {
+class Counters final {
 private:
-    ::std::istream& istream; // Input stream
-public:
-    /** Build a simple input stream.
-     * @param istream Input stream to use
-    **/
-    StreamInput(::std::istream& istream): istream(istream) {}
-public:
-    /** Load one value.
-     * @return value Value stored
+    int  leader; // Group leader descriptor (negative if unavailable)
+    int  fds[event_count];   // Descriptor of each event (negative if unavailable)
+    nat_t slots[event_count]; // Position of each opened event in a group read
+    nat_t opened; // Number of opened events
+    int  error;  // Error of the leader opening
+private:
+    /** Open an event.
+     * @param type   Event type
+     * @param config Event configuration
+     * @param group  Group leader descriptor (-1 for a new group)
+     * @return Descriptor, negative on failure
     **/
-    val_t load() {
-        val_t value;
-        istream.read(reinterpret_cast<::std::remove_reference<decltype(istream)>::type::char_type*>(&value), sizeof(val_t));
-        return value;
+    static int open(uint32_t type, uint64_t config, int group) {
+        ::perf_event_attr attr;
+        ::std::memset(&attr, 0, sizeof(attr));
+        attr.size   = sizeof(attr);
+        attr.type   = type;
+        attr.config = config;
+        attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_kernel = 1; // Allowed to unprivileged users by default
+        attr.exclude_hv     = 1;
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
     }
-};
-
-/** Output serializer based on a stream.
-**/
-class StreamOutput final: public Output {
-private:
-    ::std::ostream& ostream; // Output stream
-public:
-    /** Build a simple output stream.
-     * @param ostream Output stream to use
+    /** Get the configuration of a hardware cache event.
+     * @param cache Cache id
+     * @return Configuration for read misses
     **/
-    StreamOutput(::std::ostream& ostream): ostream(ostream) {}
+    constexpr static uint64_t miss(uint64_t cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
 public:
-    /** Store one value.
-     * @param value Value stored
+    /** Open the event group of the calling thread, the missing events being left out.
     **/
-    void store(val_t value) {
-        ostream.write(reinterpret_cast<::std::remove_reference<decltype(ostream)>::type::char_type*>(&value), sizeof(val_t));
+    Counters(): leader(-1), opened(0), error(0) {
+        uint32_t const types[event_count]   = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE };
+        uint64_t const configs[event_count] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, miss(PERF_COUNT_HW_CACHE_L1D), miss(PERF_COUNT_HW_CACHE_LL), PERF_COUNT_HW_BRANCH_MISSES };
+        for (nat_t i = 0; i < event_count; i++) {
+            fds[i] = open(types[i], configs[i], leader);
+            if (fds[i] < 0) {
+                if (i == 0) { // No cycle counter, nothing to group
+                    error = errno;
+                    break;
+                }
+                continue;
+            }
+            if (i == 0)
+                leader = fds[i];
+            slots[i] = opened++;
+        }
+        if (leader < 0) {
+            for (nat_t i = 0; i < event_count; i++)
+                fds[i] = -1;
+        }
+    }
+    /** Copy constructor (deleted).
+    **/
+    Counters(Counters const&) = delete;
+    /** Close the event group.
+    **/
+    ~Counters() {
+        for (nat_t i = 0; i < event_count; i++) {
+            if (fds[i] >= 0)
+                ::close(fds[i]);
+        }
+    }
+public:
+    /** Get the event group of the calling thread, opened at first use.
+     * @return Event group
+    **/
+    static Counters& local() {
+        thread_local Counters counters;
+        return counters;
+    }
+public:
+    /** Check whether the counters are available.
+     * @return True if available, false otherwise
+    **/
+    bool available() const {
+        return leader >= 0;
+    }
+    /** Check whether an event is counted.
+     * @param event Event index
+     * @return True if counted, false otherwise
+    **/
+    bool counted(nat_t event) const {
+        return fds[event] >= 0;
+    }
+    /** Get the error of the opening.
+     * @return 'errno' value of the failed opening (0 if none)
+    **/
+    int failure() const {
+        return error;
+    }
+    /** Read the counters.
+     * @param sample Counter values (output, zero for the events not counted)
+    **/
+    void read(Sample& sample) const {
+        uint64_t buffer[3 + event_count]; // Number of events, enabled and running times, then their values
+        if (::read(leader, buffer, sizeof(buffer)) < static_cast<ssize_t>((3 + opened) * sizeof(uint64_t))) {
+            ::std::memset(&sample, 0, sizeof(sample));
+            return;
+        }
+        sample.enabled = buffer[1];
+        sample.running = buffer[2];
+        for (nat_t i = 0; i < event_count; i++)
+            sample.values[i] = (fds[i] >= 0 ? buffer[3 + slots[i]] : 0);
     }
 };
 
-} }
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Accumulated counters of a region.
+**/
+class Profile final {
+public:
+    ::std::atomic<uint64_t> calls;   // Number of profiled scopes
+    ::std::atomic<uint64_t> samples; // Number of processed samples
+    ::std::atomic<uint64_t> totals[event_count]; // Total of each event
+public:
+    /** Empty profile constructor.
+    **/
+    Profile(): calls(0), samples(0) {
+        for (nat_t i = 0; i < event_count; i++)
+            totals[i].store(0, ::std::memory_order_relaxed);
+    }
+public:
+    /** Forget every accumulated count.
+    **/
+    void reset() {
+        calls.store(0, ::std::memory_order_relaxed);
+        samples.store(0, ::std::memory_order_relaxed);
+        for (nat_t i = 0; i < event_count; i++)
+            totals[i].store(0, ::std::memory_order_relaxed);
+    }
+};
+
+/** Scoped counter reading, accumulating the counts of its lifetime into a profile.
+**/
+class Scope final {
+private:
+    Profile*  profile; // Profile to feed (null for none)
+    Counters* counters; // Counters of the calling thread
+    uint64_t  samples; // Number of samples processed in the scope
+    Sample    start;   // Counter values at construction
+public:
+    /** Read the counters.
+     * @param profile Profile to feed (null for none)
+     * @param samples Number of samples processed in the scope
+    **/
+    Scope(Profile* profile, uint64_t samples): profile(profile), counters(null), samples(samples) {
+        if (!profile)
+            return;
+        counters = &Counters::local();
+        if (counters->available())
+            counters->read(start);
+    }
+    /** Copy constructor (deleted).
+    **/
+    Scope(Scope const&) = delete;
+    /** Read the counters again, accumulate the differences.
+    **/
+    ~Scope() {
+        if (!profile || !counters->available())
+            return;
+        Sample stop;
+        counters->read(stop);
+        uint64_t enabled = stop.enabled - start.enabled;
+        uint64_t running = stop.running - start.running;
+        if (running == 0) // Group never scheduled during the scope, nothing to extrapolate from
+            return;
+        double scale = static_cast<double>(enabled) / static_cast<double>(running); // 1 unless multiplexed
+        profile->calls.fetch_add(1, ::std::memory_order_relaxed);
+        profile->samples.fetch_add(samples, ::std::memory_order_relaxed);
+        for (nat_t i = 0; i < event_count; i++)
+            profile->totals[i].fetch_add(static_cast<uint64_t>(static_cast<double>(stop.values[i] - start.values[i]) * scale + 0.5), ::std::memory_order_relaxed);
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Named profiles, in creation order; profiles are never destroyed.
+**/
+class Registry final {
+private:
+    ::std::mutex lock; // Registry lock
+    ::std::vector<::std::pair<::std::string, ::std::unique_ptr<Profile>>> entries; // Named profiles
+private:
+    /** Empty registry constructor.
+    **/
+    Registry(): lock(), entries() {}
+public:
+    /** Get the process-wide registry.
+     * @return Registry instance
+    **/
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+public:
+    /** Get a profile by name, created if needed.
+     * @param name Profile name
+     * @return Profile
+    **/
+    Profile& get(::std::string const& name) {
+        ::std::lock_guard<::std::mutex> guard(lock);
+        for (auto& entry: entries) {
+            if (entry.first == name)
+                return *entry.second;
+        }
+        entries.emplace_back(name, ::std::unique_ptr<Profile>(new Profile()));
+        return *entries.back().second;
+    }
+    /** Forget every accumulated count.
+    **/
+    void reset() {
+        ::std::lock_guard<::std::mutex> guard(lock);
+        for (auto& entry: entries)
+            entry.second->reset();
+    }
+    /** Print every non-empty profile: IPC, then events per sample.
+     * @param ostr Output stream
+    **/
+    void dump(::std::ostream& ostr) {
+        Counters const& counters = Counters::local();
+        if (!counters.available()) {
+            ostr << "Hardware counters unavailable: " << ::std::strerror(counters.failure()) << ::std::endl;
+            return;
+        }
+        ::std::lock_guard<::std::mutex> guard(lock);
+        ostr << "name\tcalls\tsamples\tIPC";
+        for (nat_t i = 0; i < event_count; i++)
+            ostr << "\t" << event_names[i] << "/sample";
+        ostr << ::std::endl;
+        for (auto& entry: entries) {
+            Profile const& profile = *entry.second;
+            uint64_t samples = profile.samples.load(::std::memory_order_relaxed);
+            if (samples == 0)
+                continue;
+            uint64_t cycles = profile.totals[0].load(::std::memory_order_relaxed);
+            uint64_t instrs = profile.totals[1].load(::std::memory_order_relaxed);
+            ostr << entry.first << "\t" << profile.calls.load(::std::memory_order_relaxed) << "\t" << samples << "\t";
+            if (cycles > 0 && counters.counted(1)) {
+                ostr << static_cast<double>(instrs) / static_cast<double>(cycles);
+            } else {
+                ostr << "-";
+            }
+            for (nat_t i = 0; i < event_count; i++) {
+                ostr << "\t";
+                if (counters.counted(i)) {
+                    ostr << static_cast<double>(profile.totals[i].load(::std::memory_order_relaxed)) / static_cast<double>(samples);
+                } else {
+                    ostr << "-";
+                }
+            }
+            ostr << ::std::endl;
+        }
+    }
+};
+
+}
+}
+#endif
+
+/** Profile the rest of the enclosing scope, once per scope, if 'STATICNET_PROFILE' includes the region.
+ * @param region  Region of the scope, in 'Profiling'
+ * @param name    Profile name, evaluated at the first call only
+ * @param samples Number of samples processed in the scope
+**/
+#undef profiled_scope
+#ifdef STATICNET_PROFILE
+    #define profiled_scope(region, name, samples) \
+        static ::StaticNet::Profiling::Profile* const profiled_profile = ((STATICNET_PROFILE) & (region)) ? &::StaticNet::Profiling::Registry::instance().get(name) : null; \
+        ::StaticNet::Profiling::Scope profiled_guard(profiled_profile, (samples))
+#else
+    #define profiled_scope(region, name, samples)
+#endif
 
 // ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
-// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Input/Output serializer ▔
-// ▁ Simple vector ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Profiling ▔
+// ▁ Random number generator ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
 
 namespace StaticNet {
 
-/** Simple vector class.
- * @param dim Vector dimension
+/** Abstract randomizer.
 **/
-template<nat_t dim> class Vector final {
-    static_assert(dim > 0, "Invalid vector dimension");
+class Randomizer {
+public:
+    /** Get a random number.
+    **/
+    virtual val_t get() = 0;
+    /** Get consecutive random numbers, as successive calls to 'get' would.
+     * @param values Random numbers (output)
+     * @param count  Number of random numbers
+    **/
+    virtual void fill(val_t* values, nat_t count) {
+        for (nat_t i = 0; i < count; i++)
+            values[i] = get();
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Uniform distribution randomizer.
+ * @param Ratio Uniform distribution over [-ratio(), +ratio()]
+**/
+template<class Ratio> class UniformRandomizer final: public Randomizer {
 private:
-    val_t vec[dim]; // Vector
+    /** Compute floating-point ratio from the ::std::ratio type "compatible" template parameter.
+     * @return Floating-point representation of the ratio
+    **/
+    constexpr val_t ratio() {
+        constexpr val_t ret = static_cast<val_t>(Ratio::num) / static_cast<val_t>(Ratio::den);
+        static_assert(ret > 0, "'Ratio' must be a positive value");
+        return ret;
+    }
+private:
+    ::std::random_device                    device;
+    ::std::default_random_engine            engine;
+    ::std::uniform_real_distribution<val_t> distrib;
 public:
-    /** Uninitialized constructor.
+    /** Constructor.
     **/
-    Vector() {}
-    /** Copy constructor.
-     * @param copy Vector to copy
+    UniformRandomizer(): device(), engine(device()), distrib(-ratio(), ratio()) {}
+public:
+    /** Get a random number.
+     * @return A random number
     **/
-    Vector(Vector<dim> const& copy) {
-        for (nat_t i = 0; i < dim; i++)
-            vec[i] = copy.get(i);
+    val_t get() {
+        return distrib(engine);
     }
-    /** Initializer list constructor.
-     * @param params Initial values (cardinality must be the dimension of the vector)
+};
+
+/** Uniform distribution randomizer, counter-based (Philox4x32-10) and explicitly seeded.
+ * The number at a given position of the stream only depends on the seed and the position, so that any part of the
+ * stream can be generated independently (e.g. by several threads) with the same result.
+ * @param Ratio Uniform distribution over [-ratio(), +ratio()[
+**/
+template<class Ratio> class PhiloxRandomizer final: public Randomizer {
+private:
+    constexpr static uint32_t mul0   = 0xD2511F53; // Round multipliers
+    constexpr static uint32_t mul1   = 0xCD9E8D57;
+    constexpr static uint32_t weyl0  = 0x9E3779B9; // Key schedule increments
+    constexpr static uint32_t weyl1  = 0xBB67AE85;
+    constexpr static nat_t    rounds = 10; // Number of rounds
+    constexpr static nat_t    lanes  = 4;  // Numbers per block
+    constexpr static nat_t    batch  = 32; // Blocks generated at once, enough for the round loop to be vectorized
+    constexpr static nat_t    span   = lanes * batch; // Numbers per batch
+private:
+    /** Compute floating-point ratio from the ::std::ratio type "compatible" template parameter.
+     * @return Floating-point representation of the ratio
     **/
-    Vector(::std::initializer_list<val_t> params) {
-        /// FIXME: Non-constant condition here. Missing a 'correction' brought by C++17 ? See 'http://en.cppreference.com/w/cpp/utility/initializer_list/size' then 'http://en.cppreference.com/w/cpp/iterator/distance'.
-        // static_assert(params.size() != dim, "Wrong initializer list size");
-        nat_t i = 0;
-        for (val_t v: params)
-            vec[i++ % dim] = v; /// NOTE: Temporary modulo
+    constexpr static val_t ratio() {
+        static_assert(Ratio::num > 0 && Ratio::den > 0, "'Ratio' must be a positive value");
+        return static_cast<val_t>(Ratio::num) / static_cast<val_t>(Ratio::den);
+    }
+private:
+    uint32_t key0;     // Key, from the seed
+    uint32_t key1;
+    uint64_t position; // Position of the next number of 'get'
+    uint64_t cached;   // Position of the first cached number
+    val_t cache[span]; // Cached numbers
+private:
+    /** Generate a batch of consecutive blocks.
+     * @param block First block index
+     * @param out   Output words, in stream order
+    **/
+    void generate(uint64_t block, uint32_t (&out)[span]) const {
+        uint32_t c0[batch], c1[batch], c2[batch], c3[batch];
+        for (nat_t j = 0; j < batch; j++) {
+            c0[j] = static_cast<uint32_t>(block + j);
+            c1[j] = static_cast<uint32_t>((block + j) >> 32);
+            c2[j] = 0;
+            c3[j] = 0;
+        }
+        uint32_t k0 = key0;
+        uint32_t k1 = key1;
+        for (nat_t r = 0; r < rounds; r++) {
+            for (nat_t j = 0; j < batch; j++) { // Independent blocks, vectorizable
+                uint64_t p0 = static_cast<uint64_t>(mul0) * c0[j];
+                uint64_t p1 = static_cast<uint64_t>(mul1) * c2[j];
+                uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1[j] ^ k0;
+                uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3[j] ^ k1;
+                c1[j] = static_cast<uint32_t>(p1);
+                c3[j] = static_cast<uint32_t>(p0);
+                c0[j] = n0;
+                c2[j] = n2;
+            }
+            k0 += weyl0;
+            k1 += weyl1;
+        }
+        for (nat_t j = 0; j < batch; j++) {
+            out[j * lanes + 0] = c0[j];
+            out[j * lanes + 1] = c1[j];
+            out[j * lanes + 2] = c2[j];
+            out[j * lanes + 3] = c3[j];
+        }
     }
 public:
-    /** Get a single coordinate.
-     * @param id Coordinate id
-     * @return Coordinate value
+    /** Seeded constructor.
+     * @param seed     Seed of the stream
+     * @param position Position of the first number of 'get' (optional)
     **/
-    val_t get(nat_t id) const {
-        return vec[id];
+    PhiloxRandomizer(uint64_t seed, uint64_t position = 0): key0(static_cast<uint32_t>(seed)), key1(static_cast<uint32_t>(seed >> 32)), position(position), cached(::std::numeric_limits<uint64_t>::max()) {}
+private:
+    /** Convert a generated word to a number of the distribution.
+     * @param word Generated word
+     * @return Random number
+    **/
+    constexpr static val_t convert(uint32_t word) {
+        return static_cast<val_t>(word >> 8) * (2 * ratio() / static_cast<val_t>(1 << 24)) - ratio(); // 24-bit mantissa
     }
-    /** Set a single coordinate.
-     * @param id Coordinate id
-     * @param cv Coordinate value
+    /** Get the numbers at the given positions of the stream, then optionally the one right after them.
+     * @param values Random numbers (output)
+     * @param count  Number of random numbers
+     * @param first  Position of the first number
+     * @param next   Number right after them (output, null for none)
     **/
-    void set(nat_t id, val_t cv) {
-        vec[id] = cv;
+    void generate(val_t* values, nat_t count, uint64_t first, val_t* next) const {
+        uint32_t words[span];
+        uint64_t end  = first + count; // Position of the number right after
+        uint64_t last = end; // Position of the batch in 'words' (none yet: not a batch position unless 'end' is one)
+        nat_t skip = static_cast<nat_t>(first % span); // Numbers to skip in the first batch
+        for (uint64_t index = first - skip; count > 0; index += span) {
+            generate(index / lanes, words);
+            last = index;
+            nat_t take = ::std::min<nat_t>(span - skip, count);
+            for (nat_t i = 0; i < take; i++)
+                values[i] = convert(words[skip + i]);
+            values += take;
+            count  -= take;
+            skip    = 0;
+        }
+        if (!next)
+            return;
+        if (last == end || end - last >= span) { // Not in the last batch generated
+            last = end - end % span;
+            generate(last / lanes, words);
+        }
+        *next = convert(words[end - last]);
     }
 public:
-    /** Copy assignment.
-     * @param x Vector to copy
-     * @return Current vector
+    /** Get the numbers at the given positions of the stream, without moving the stream (thread-safe).
+     * @param values Random numbers (output)
+     * @param count  Number of random numbers
+     * @param first  Position of the first number
     **/
-    Vector<dim>& operator=(Vector<dim> const& x) {
-        for (nat_t i = 0; i < dim; i++)
-            set(i, x.get(i));
-        return *this;
+    void generate(val_t* values, nat_t count, uint64_t first) const {
+        generate(values, count, first, null);
     }
-    /** Initializer list assignment.
-     * @param params Initial values (cardinality must be the dimension of the vector)
-     * @return Current vector
+    /** Get the numbers at the given positions of the stream then the one right after them, in a separate place, from the same batches.
+     * @param values Random numbers (output)
+     * @param count  Number of random numbers
+     * @param first  Position of the first number
+     * @param next   Number right after them (output)
     **/
-    Vector<dim>& operator=(::std::initializer_list<val_t> params) {
-        /// FIXME: Non-constant condition here. Same remark.
-        // static_assert(params.size() != dim, "Wrong initializer list size");
-        nat_t i = 0;
-        for (val_t v: params)
-            vec[i++ % dim] = v; /// NOTE: Temporary modulo
-        return *this;
+    void generate(val_t* values, nat_t count, uint64_t first, val_t& next) const {
+        generate(values, count, first, &next);
     }
-    /** Scalar product.
-     * @param x Vector to substract
-     * @return Current vector
+    /** Get a random number.
+     * @return A random number
     **/
-    val_t operator*(Vector<dim> const& x) const {
-        val_t sum = 0;
-        for (nat_t i = 0; i < dim; i++)
-            sum += get(i) * x.get(i);
-        return sum;
+    val_t get() {
+        if (unlikely(position < cached || position - cached >= span)) { // Not cached
+            cached = position - position % span;
+            generate(cache, span, cached);
+        }
+        return cache[(position++) - cached];
+    }
+    /** Get consecutive random numbers, as successive calls to 'get' would.
+     * @param values Random numbers (output)
+     * @param count  Number of random numbers
+    **/
+    void fill(val_t* values, nat_t count) {
+        generate(values, count, position);
+        position += count;
+    }
+    /** Get the position of the next number of 'get'.
+     * @return Stream position
+    **/
+    uint64_t tell() const {
+        return position;
+    }
+    /** Set the position of the next number of 'get'.
+     * @param pos Stream position
+    **/
+    void seek(uint64_t pos) {
+        position = pos;
+    }
+};
+
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Random number generator ▔
+// ▁ Transfert function ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+
+/** Transfert function.
+**/
+class Transfert final {
+private:
+    constexpr static val_t diff_delta = 0.01; // Delta for derivative estimation
+private:
+    nat_t  count; // Nb points - 1
+    val_t  x_min; // Min input
+    val_t  x_max; // Max input
+    val_t  delta; // Difference between max/min
+    val_t  scale; // Points per input unit (= count / delta)
+    val_t* tbase; // Points of base function (null if not initialized)
+    val_t* tdiff; // Points of derived function (= base + prec)
+private:
+    /** Function type selector.
+    **/
+    enum class select { base, diff }; // Function type selector
+    /** Select a table.
+     * @param func Table to select
+     * @return Selected table
+    **/
+    template<select func> val_t* get() const {
+        switch (func) {
+            case select::base:
+                return tbase;
+            case select::diff:
+                return tdiff;
+        }
+    }
+    /** Interpolate (linearly) a value through this function/its derivative/other.
+     * @param func Selected function ('base' or 'diff')
+     * @param x    Input value
+     * @return Output value
+    **/
+    template<select func> val_t interpolate(val_t x) const {
+        if (unlikely(x < x_min)) {
+            return get<func>()[0];
+        } else if (unlikely(x >= x_max)) {
+            return get<func>()[count];
+        } // Else linear interpolation
+        val_t t = (x - x_min) * scale;
+        nat_t i = static_cast<nat_t>(t); // Truncated
+        if (unlikely(i >= count)) { // Due to floating-point imprecision
+            return get<func>()[count];
+        } else {
+            val_t y_a = get<func>()[i];
+            val_t y_b = get<func>()[i + 1];
+            return y_a + (y_b - y_a) * (t - static_cast<val_t>(i)); // Fractional part, 't' being non-negative
+        }
+    }
+public:
+    /** Constructor.
+    **/
+    Transfert(): tbase(null) {}
+    /** Destructor.
+    **/
+    ~Transfert() {
+        if (tbase)
+            ::std::free(static_cast<void*>(tbase));
+    }
+public:
+    /** Pass parameter through the transfert function.
+     * @param x Input value
+     * @return Output value
+    **/
+    val_t operator()(val_t x) const {
+        return interpolate<select::base>(x);
+    }
+    /** Pass parameter through the transfert function derivative.
+     * @param x Input value
+     * @return Output value
+    **/
+    val_t diff(val_t x) const {
+        return interpolate<select::diff>(x);
+    }
+    /** (Re)set the transfert function, with optional weight correction.
+     * @param trans Transfert function
+     * @param min   Min input
+     * @param max   Max input
+     * @param prec  Amount of points
+     * @param corr  Weight correction (optional)
+     * @return True if the operation is a success, false otherwise
+    **/
+    bool set(val_t trans(val_t), val_t min, val_t max, nat_t prec) {
+        if (unlikely(min >= max || prec < 2)) // Basic checks
+            return false;
+        { // Points table allocation
+            if (tbase) // Points table freeing (if already exists)
+                ::std::free(static_cast<void*>(tbase));
+            void* addr = ::std::malloc(2 * prec * sizeof(val_t));
+            if (!addr) { // Allocation failure
+                tbase = null;
+                return false;
+            }
+            tbase = static_cast<val_t*>(addr);
+            tdiff = tbase + prec;
+        }
+        { // Tables initialization
+            x_min = min;
+            x_max = max;
+            delta = max - min;
+            count = prec - 1;
+            scale = static_cast<val_t>(count) / delta;
+            val_t const prec1 = static_cast<val_t>(prec - 1);
+            for (nat_t i = 0; i < prec; i++) { // Base and diff
+                val_t x = delta * static_cast<val_t>(i) / prec1 + x_min;
+                tbase[i] = trans(x);
+                tdiff[i] = (trans(x + diff_delta / 2) - trans(x - diff_delta / 2)) / diff_delta;
+            }
+        }
+        return true;
+    }
+public:
+    /** Print functions (transfert, transfert derivative, weight correction) to the given stream, to plot them.
+     * @param ostr Output stream
+    **/
+    void print(::std::ostream& ostr) const {
+        val_t const prec1 = static_cast<val_t>(count);
+        for (nat_t i = 0; i <= count; i++) { // Base and diff
+            val_t x = delta * static_cast<val_t>(i) / prec1 + x_min;
+            ostr << x << "\t" << interpolate<select::base>(x) << "\t" << interpolate<select::diff>(x) << ::std::endl;
+        }
+    }
+};
+
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Transfert function ▔
+// ▁ Activation functions ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+namespace Activation {
+
+/** Activation functions share the following interface:
+ *   Act(Transfert const& trans); // Constructor, from the transfert function given to the network
+ *   val_t operator()(val_t x) const; // Pass the sum of weighted inputs through the function
+ *   val_t diff(val_t x) const; // Pass the sum of weighted inputs through the derivative
+ * Activation policies select the function of each layer:
+ *   using head = ...; // Activation function of the first layer
+ *   using tail = ...; // Policy for the following layers
+ *   using last = ...; // Activation function if the first layer is also the output layer
+**/
+
+/** Transfert function lookup table.
+**/
+class Table final {
+private:
+    Transfert const* trans; // Transfert function to use
+public:
+    /** Table constructor.
+     * @param trans Transfert function to use
+    **/
+    Table(Transfert const& trans): trans(&trans) {}
+public:
+    /** Pass parameter through the transfert function.
+     * @param x Input value
+     * @return Output value
+    **/
+    val_t operator()(val_t x) const {
+        return (*trans)(x);
+    }
+    /** Pass parameter through the transfert function derivative.
+     * @param x Input value
+     * @return Output value
+    **/
+    val_t diff(val_t x) const {
+        return trans->diff(x);
+    }
+};
+
+/** Rectified linear unit.
+**/
+class Relu final {
+public:
+    /** Default constructor.
+    **/
+    Relu() {}
+    /** Constructor, transfert function ignored.
+    **/
+    Relu(Transfert const&) {}
+public:
+    /** Pass parameter through the function.
+     * @param x Input value
+     * @return Output value
+    **/
+    val_t operator()(val_t x) const {
+        return x > 0 ? x : 0;
+    }
+    /** Pass parameter through the derivative.
+     * @param x Input value
+     * @return Output value
+    **/
+    val_t diff(val_t x) const {
+        return x > 0 ? 1 : 0;
+    }
+};
+
+/** Leaky rectified linear unit.
+ * @param Ratio Slope for negative inputs
+**/
+template<class Ratio = ::std::ratio<1, 100>> class LeakyRelu final {
+private:
+    /** Get the slope for negative inputs.
+     * @return Slope
+    **/
+    constexpr static val_t slope() {
+        return static_cast<val_t>(Ratio::num) / static_cast<val_t>(Ratio::den);
+    }
+public:
+    /** Default constructor.
+    **/
+    LeakyRelu() {}
+    /** Constructor, transfert function ignored.
+    **/
+    LeakyRelu(Transfert const&) {}
+public:
+    /** Pass parameter through the function.
+     * @param x Input value
+     * @return Output value
+    **/
+    val_t operator()(val_t x) const {
+        return x > 0 ? x : x * slope();
+    }
+    /** Pass parameter through the derivative.
+     * @param x Input value
+     * @return Output value
+    **/
+    val_t diff(val_t x) const {
+        return x > 0 ? 1 : slope();
+    }
+};
+
+/** Hyperbolic tangent, linear on [-1, 1] and saturated outside.
+**/
+class HardTanh final {
+public:
+    /** Default constructor.
+    **/
+    HardTanh() {}
+    /** Constructor, transfert function ignored.
+    **/
+    HardTanh(Transfert const&) {}
+public:
+    /** Pass parameter through the function.
+     * @param x Input value
+     * @return Output value
+    **/
+    val_t operator()(val_t x) const {
+        return x > 1 ? 1 : (x < -1 ? -1 : x);
+    }
+    /** Pass parameter through the derivative.
+     * @param x Input value
+     * @return Output value
+    **/
+    val_t diff(val_t x) const {
+        return (x > 1 || x < -1) ? 0 : 1;
+    }
+};
+
+/** Identity.
+**/
+class Identity final {
+public:
+    /** Default constructor.
+    **/
+    Identity() {}
+    /** Constructor, transfert function ignored.
+    **/
+    Identity(Transfert const&) {}
+public:
+    /** Pass parameter through the function.
+     * @param x Input value
+     * @return Output value
+    **/
+    val_t operator()(val_t x) const {
+        return x;
+    }
+    /** Pass parameter through the derivative.
+     * @return Output value
+    **/
+    val_t diff(val_t) const {
+        return 1;
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Same activation function for every layer.
+ * @param Act Activation function
+**/
+template<class Act> class Uniform final {
+public:
+    using head = Act;
+    using tail = Uniform<Act>;
+    using last = Act;
+};
+
+/** One activation function for the hidden layers, another for the output layer.
+ * @param Inner Activation function of the hidden layers
+ * @param Outer Activation function of the output layer
+**/
+template<class Inner, class Outer> class Hidden final {
+public:
+    using head = Inner;
+    using tail = Hidden<Inner, Outer>;
+    using last = Outer;
+};
+
+/** One activation function per layer, in order, exactly as many as there are layers.
+ * @param Act    Activation function of the first layer
+ * @param Others Activation functions of the following layers
+**/
+template<class Act, class... Others> class List final {
+private:
+    /** Output layer reached with activation functions left.
+    **/
+    template<class Other> class Surplus final {
+        static_assert(sizeof(Other) == 0, "Too many activation functions for the layers");
+    };
+public:
+    using head = Act;
+    using tail = List<Others...>;
+    using last = Surplus<Act>;
+};
+template<class Act> class List<Act> final {
+private:
+    /** Tail of an exhausted list.
+    **/
+    template<class Other> class Missing final {
+        static_assert(sizeof(Other) == 0, "Not enough activation functions for the layers");
+    };
+public:
+    using head = Act;
+    using tail = Missing<Act>;
+    using last = Act;
+};
+
+} }
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Activation functions ▔
+// ▁ Input/Output serializer ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+namespace Serializer {
+
+/** Abstract input serializer class.
+**/
+class Input {
+public:
+    /** Load one value, in order of writing.
+     * @return Value loaded
+    **/
+    virtual val_t load() = 0;
+    /** Load one count or index, stored by 'Output::store_index'.
+     * @return Count or index loaded
+    **/
+    nat_t load_index() {
+        val_t value = load();
+        uint32_t bits;
+        ::std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+};
+
+/** Abstract output serializer class.
+**/
+class Output {
+public:
+    /** Store one value.
+     * @param Value stored
+    **/
+    virtual void store(val_t) = 0;
+    /** Store one count or index, bit for bit in a value slot, so that it stays exact beyond the float precision.
+     * @param index Count or index stored, below 2^32
+    **/
+    void store_index(nat_t index) {
+        static_assert(sizeof(val_t) == sizeof(uint32_t), "Indices need a value slot of 32 bits");
+        uint32_t bits = static_cast<uint32_t>(index);
+        val_t value;
+        ::std::memcpy(&value, &bits, sizeof(value));
+        store(value);
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Input serializer based on a stream.
+**/
+class StreamInput final: public Input {
+private:
+    ::std::istream& istream; // Input stream
+public:
+    /** Build a simple input stream.
+     * @param istream Input stream to use
+    **/
+    StreamInput(::std::istream& istream): istream(istream) {}
+public:
+    /** Load one value.
+     * @return value Value stored
+    **/
+    val_t load() {
+        val_t value;
+        istream.read(reinterpret_cast<::std::remove_reference<decltype(istream)>::type::char_type*>(&value), sizeof(val_t));
+        return value;
+    }
+};
+
+/** Output serializer based on a stream.
+**/
+class StreamOutput final: public Output {
+private:
+    ::std::ostream& ostream; // Output stream
+public:
+    /** Build a simple output stream.
+     * @param ostream Output stream to use
+    **/
+    StreamOutput(::std::ostream& ostream): ostream(ostream) {}
+public:
+    /** Store one value.
+     * @param value Value stored
+    **/
+    void store(val_t value) {
+        ostream.write(reinterpret_cast<::std::remove_reference<decltype(ostream)>::type::char_type*>(&value), sizeof(val_t));
+    }
+};
+
+/** Output serializer writing to memory, e.g. the image of a file.
+**/
+class MemoryOutput final: public Output {
+private:
+    uint8_t* cursor; // Where to store the next value
+public:
+    /** Build a memory output.
+     * @param data Buffer, large enough for every value stored
+    **/
+    MemoryOutput(void* data): cursor(static_cast<uint8_t*>(data)) {}
+public:
+    /** Store one value.
+     * @param value Value stored
+    **/
+    void store(val_t value) {
+        ::std::memcpy(cursor, &value, sizeof(val_t));
+        cursor += sizeof(val_t);
+    }
+};
+
+} }
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Input/Output serializer ▔
+// ▁ Simple vector ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+
+template<nat_t dim> class Vector;
+
+namespace Expression {
+
+/** Lazily evaluated vector expression, evaluated coordinate by coordinate on assignment or reduction.
+ * @param dim  Expression dimension
+ * @param Self Concrete expression class
+**/
+template<nat_t dim, class Self> class Base {
+public:
+    /** Get the concrete expression.
+     * @return Concrete expression
+    **/
+    Self const& self() const {
+        return static_cast<Self const&>(*this);
+    }
+};
+
+/** How an operand is held by an expression: vectors by reference, expressions by value.
+ * @param Type Operand class
+**/
+template<class Type> class Hold final {
+public:
+    using type = Type const;
+};
+template<nat_t dim> class Hold<Vector<dim>> final {
+public:
+    using type = Vector<dim> const&;
+};
+
+/** Scalar broadcast to every coordinate.
+ * @param dim Expression dimension
+**/
+template<nat_t dim> class Scalar final: public Base<dim, Scalar<dim>> {
+private:
+    val_t value; // Broadcast value
+public:
+    /** Value constructor.
+     * @param value Broadcast value
+    **/
+    Scalar(val_t value): value(value) {}
+public:
+    /** Get a single coordinate.
+     * @return Broadcast value
+    **/
+    val_t get(nat_t) const {
+        return value;
+    }
+};
+
+/** Coordinate-wise unary operation.
+ * @param Op  Operation class, with a static 'apply(val_t)'
+ * @param dim Expression dimension
+ * @param Arg Operand class
+**/
+template<class Op, nat_t dim, class Arg> class Unary final: public Base<dim, Unary<Op, dim, Arg>> {
+private:
+    typename Hold<Arg>::type arg; // Operand
+public:
+    /** Operand constructor.
+     * @param arg Operand
+    **/
+    Unary(Arg const& arg): arg(arg) {}
+public:
+    /** Get a single coordinate.
+     * @param id Coordinate id
+     * @return Coordinate value
+    **/
+    val_t get(nat_t id) const {
+        return Op::apply(arg.get(id));
+    }
+};
+
+/** Coordinate-wise binary operation.
+ * @param Op  Operation class, with a static 'apply(val_t, val_t)'
+ * @param dim Expression dimension
+ * @param Lhs Left operand class
+ * @param Rhs Right operand class
+**/
+template<class Op, nat_t dim, class Lhs, class Rhs> class Binary final: public Base<dim, Binary<Op, dim, Lhs, Rhs>> {
+private:
+    typename Hold<Lhs>::type lhs; // Left operand
+    typename Hold<Rhs>::type rhs; // Right operand
+public:
+    /** Operands constructor.
+     * @param lhs Left operand
+     * @param rhs Right operand
+    **/
+    Binary(Lhs const& lhs, Rhs const& rhs): lhs(lhs), rhs(rhs) {}
+public:
+    /** Get a single coordinate.
+     * @param id Coordinate id
+     * @return Coordinate value
+    **/
+    val_t get(nat_t id) const {
+        return Op::apply(lhs.get(id), rhs.get(id));
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+namespace Operation {
+
+/** Absolute value.
+**/
+class Abs final {
+public:
+    static val_t apply(val_t x) {
+        return x < 0 ? -x : x;
+    }
+};
+
+/** Negation.
+**/
+class Neg final {
+public:
+    static val_t apply(val_t x) {
+        return -x;
+    }
+};
+
+/** Addition.
+**/
+class Add final {
+public:
+    static val_t apply(val_t x, val_t y) {
+        return x + y;
+    }
+};
+
+/** Substraction.
+**/
+class Sub final {
+public:
+    static val_t apply(val_t x, val_t y) {
+        return x - y;
+    }
+};
+
+/** Multiplication.
+**/
+class Mul final {
+public:
+    static val_t apply(val_t x, val_t y) {
+        return x * y;
+    }
+};
+
+/** Strictly less than comparison.
+**/
+class Less final {
+public:
+    static val_t apply(val_t x, val_t y) {
+        return x < y ? 1 : 0;
+    }
+};
+
+/** Less than or equal comparison.
+**/
+class LessEqual final {
+public:
+    static val_t apply(val_t x, val_t y) {
+        return x <= y ? 1 : 0;
+    }
+};
+
+/** Strictly greater than comparison.
+**/
+class Greater final {
+public:
+    static val_t apply(val_t x, val_t y) {
+        return x > y ? 1 : 0;
+    }
+};
+
+/** Greater than or equal comparison.
+**/
+class GreaterEqual final {
+public:
+    static val_t apply(val_t x, val_t y) {
+        return x >= y ? 1 : 0;
+    }
+};
+
+}
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/// NOTE: An expression holds its vector operands by reference, so it must not outlive them (no 'auto' over temporaries).
+
+/** Coordinate-wise absolute value.
+ * @param x Operand
+ * @return Expression
+**/
+template<nat_t dim, class X> Unary<Operation::Abs, dim, X> abs(Base<dim, X> const& x) {
+    return { x.self() };
+}
+
+/** Coordinate-wise negation.
+ * @param x Operand
+ * @return Expression
+**/
+template<nat_t dim, class X> Unary<Operation::Neg, dim, X> operator-(Base<dim, X> const& x) {
+    return { x.self() };
+}
+
+/** Coordinate-wise addition.
+ * @param x Left operand
+ * @param y Right operand
+ * @return Expression
+**/
+template<nat_t dim, class X, class Y> Binary<Operation::Add, dim, X, Y> operator+(Base<dim, X> const& x, Base<dim, Y> const& y) {
+    return { x.self(), y.self() };
+}
+
+/** Coordinate-wise substraction.
+ * @param x Left operand
+ * @param y Right operand
+ * @return Expression
+**/
+template<nat_t dim, class X, class Y> Binary<Operation::Sub, dim, X, Y> operator-(Base<dim, X> const& x, Base<dim, Y> const& y) {
+    return { x.self(), y.self() };
+}
+
+/** Coordinate-wise (Hadamard) product, 'operator*' between vectors being the scalar product.
+ * @param x Left operand
+ * @param y Right operand
+ * @return Expression
+**/
+template<nat_t dim, class X, class Y> Binary<Operation::Mul, dim, X, Y> hadamard(Base<dim, X> const& x, Base<dim, Y> const& y) {
+    return { x.self(), y.self() };
+}
+
+/** Scaling by a scalar.
+ * @param x Operand
+ * @param s Scale factor
+ * @return Expression
+**/
+template<nat_t dim, class X> Binary<Operation::Mul, dim, X, Scalar<dim>> operator*(Base<dim, X> const& x, val_t s) {
+    return { x.self(), s };
+}
+template<nat_t dim, class X> Binary<Operation::Mul, dim, X, Scalar<dim>> operator*(val_t s, Base<dim, X> const& x) {
+    return { x.self(), s };
+}
+
+/** Coordinate-wise comparisons, each coordinate being 1 if true, 0 otherwise.
+ * @param x Left operand
+ * @param y Right operand
+ * @return Expression
+**/
+template<nat_t dim, class X, class Y> Binary<Operation::Less, dim, X, Y> operator<(Base<dim, X> const& x, Base<dim, Y> const& y) {
+    return { x.self(), y.self() };
+}
+template<nat_t dim, class X, class Y> Binary<Operation::LessEqual, dim, X, Y> operator<=(Base<dim, X> const& x, Base<dim, Y> const& y) {
+    return { x.self(), y.self() };
+}
+template<nat_t dim, class X, class Y> Binary<Operation::Greater, dim, X, Y> operator>(Base<dim, X> const& x, Base<dim, Y> const& y) {
+    return { x.self(), y.self() };
+}
+template<nat_t dim, class X, class Y> Binary<Operation::GreaterEqual, dim, X, Y> operator>=(Base<dim, X> const& x, Base<dim, Y> const& y) {
+    return { x.self(), y.self() };
+}
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Sum of the coordinates.
+ * @param x Expression to reduce
+ * @return Sum
+**/
+template<nat_t dim, class X> val_t sum(Base<dim, X> const& x) {
+    X const& e = x.self();
+    val_t total = 0;
+    for (nat_t i = 0; i < dim; i++)
+        total += e.get(i);
+    return total;
+}
+
+/** Scalar product of two expressions.
+ * @param x Left operand
+ * @param y Right operand
+ * @return Scalar product
+**/
+template<nat_t dim, class X, class Y> val_t dot(Base<dim, X> const& x, Base<dim, Y> const& y) {
+    return sum(hadamard(x, y));
+}
+
+/** Greatest coordinate.
+ * @param x Expression to reduce
+ * @return Greatest coordinate
+**/
+template<nat_t dim, class X> val_t maximum(Base<dim, X> const& x) {
+    X const& e = x.self();
+    val_t max = e.get(0);
+    for (nat_t i = 1; i < dim; i++) {
+        val_t value = e.get(i);
+        if (value > max)
+            max = value;
+    }
+    return max;
+}
+
+/** Smallest coordinate.
+ * @param x Expression to reduce
+ * @return Smallest coordinate
+**/
+template<nat_t dim, class X> val_t minimum(Base<dim, X> const& x) {
+    X const& e = x.self();
+    val_t min = e.get(0);
+    for (nat_t i = 1; i < dim; i++) {
+        val_t value = e.get(i);
+        if (value < min)
+            min = value;
+    }
+    return min;
+}
+
+/** Check whether every coordinate is nonzero, stopping at the first zero one.
+ * @param x Expression to reduce (typically a comparison)
+ * @return True if every coordinate is nonzero, false otherwise
+**/
+template<nat_t dim, class X> bool all(Base<dim, X> const& x) {
+    X const& e = x.self();
+    for (nat_t i = 0; i < dim; i++)
+        if (e.get(i) == 0)
+            return false;
+    return true;
+}
+
+/** Check whether any coordinate is nonzero, stopping at the first nonzero one.
+ * @param x Expression to reduce (typically a comparison)
+ * @return True if at least one coordinate is nonzero, false otherwise
+**/
+template<nat_t dim, class X> bool any(Base<dim, X> const& x) {
+    X const& e = x.self();
+    for (nat_t i = 0; i < dim; i++)
+        if (e.get(i) != 0)
+            return true;
+    return false;
+}
+
+}
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Simple vector class.
+ * @param dim Vector dimension
+**/
+template<nat_t dim> class Vector final: public Expression::Base<dim, Vector<dim>> {
+    static_assert(dim > 0, "Invalid vector dimension");
+private:
+    val_t vec[dim]; // Vector
+public:
+    /** Uninitialized constructor.
+    **/
+    Vector() {}
+    /** Copy constructor.
+     * @param copy Vector to copy
+    **/
+    Vector(Vector<dim> const& copy) {
+        for (nat_t i = 0; i < dim; i++)
+            vec[i] = copy.get(i);
+    }
+    /** Expression constructor, evaluated in a single pass.
+     * @param x Expression to evaluate
+    **/
+    template<class X> Vector(Expression::Base<dim, X> const& x) {
+        *this = x;
+    }
+    /** Initializer list constructor.
+     * @param params Initial values (cardinality must be the dimension of the vector)
+    **/
+    Vector(::std::initializer_list<val_t> params) {
+        /// FIXME: Non-constant condition here. Missing a 'correction' brought by C++17 ? See 'http://en.cppreference.com/w/cpp/utility/initializer_list/size' then 'http://en.cppreference.com/w/cpp/iterator/distance'.
+        // static_assert(params.size() != dim, "Wrong initializer list size");
+        nat_t i = 0;
+        for (val_t v: params)
+            vec[i++ % dim] = v; /// NOTE: Temporary modulo
+    }
+public:
+    /** Get a single coordinate.
+     * @param id Coordinate id
+     * @return Coordinate value
+    **/
+    val_t get(nat_t id) const {
+        return vec[id];
+    }
+    /** Set a single coordinate.
+     * @param id Coordinate id
+     * @param cv Coordinate value
+    **/
+    void set(nat_t id, val_t cv) {
+        vec[id] = cv;
+    }
+    /** Get the coordinates array.
+     * @return Coordinates array
+    **/
+    val_t* data() {
+        return vec;
+    }
+    /** Get the read-only coordinates array.
+     * @return Coordinates array
+    **/
+    val_t const* data() const {
+        return vec;
+    }
+public:
+    /** Copy assignment.
+     * @param x Vector to copy
+     * @return Current vector
+    **/
+    Vector<dim>& operator=(Vector<dim> const& x) {
+        for (nat_t i = 0; i < dim; i++)
+            set(i, x.get(i));
+        return *this;
+    }
+    /** Expression assignment, evaluated in a single pass without temporary.
+     * @param x Expression to evaluate
+     * @return Current vector
+    **/
+    template<class X> Vector<dim>& operator=(Expression::Base<dim, X> const& x) {
+        X const& e = x.self();
+        for (nat_t i = 0; i < dim; i++)
+            vec[i] = e.get(i);
+        return *this;
+    }
+    /** Expression addition, evaluated in a single pass without temporary.
+     * @param x Expression to add
+     * @return Current vector
+    **/
+    template<class X> Vector<dim>& operator+=(Expression::Base<dim, X> const& x) {
+        X const& e = x.self();
+        for (nat_t i = 0; i < dim; i++)
+            vec[i] += e.get(i);
+        return *this;
+    }
+    /** Expression substraction, evaluated in a single pass without temporary.
+     * @param x Expression to substract
+     * @return Current vector
+    **/
+    template<class X> Vector<dim>& operator-=(Expression::Base<dim, X> const& x) {
+        X const& e = x.self();
+        for (nat_t i = 0; i < dim; i++)
+            vec[i] -= e.get(i);
+        return *this;
+    }
+    /** Initializer list assignment.
+     * @param params Initial values (cardinality must be the dimension of the vector)
+     * @return Current vector
+    **/
+    Vector<dim>& operator=(::std::initializer_list<val_t> params) {
+        /// FIXME: Non-constant condition here. Same remark.
+        // static_assert(params.size() != dim, "Wrong initializer list size");
+        nat_t i = 0;
+        for (val_t v: params)
+            vec[i++ % dim] = v; /// NOTE: Temporary modulo
+        return *this;
+    }
+    /** Scalar product.
+     * @param x Vector to substract
+     * @return Current vector
+    **/
+    val_t operator*(Vector<dim> const& x) const {
+        val_t sum = 0;
+        for (nat_t i = 0; i < dim; i++)
+            sum += get(i) * x.get(i);
+        return sum;
+    }
+    /** Vector comparison.
+     * @param x Vector to compare
+     * @return True if equal, false otherwise
+    **/
+    bool operator==(Vector<dim> const& x) const {
+        for (nat_t i = 0; i < dim; i++)
+            if (x.get(i) != get(i))
+                return false;
+        return true;
+    }
+public:
+    /** Return the size of the structure.
+     * @return Size of the structure, in bytes
+    **/
+    static constexpr size_t size() {
+        return dim * sizeof(val_t);
+    }
+    /** Return the dimension of the vector.
+     * @return Vector dimension
+    **/
+    static constexpr nat_t length() {
+        return dim;
+    }
+    /** Load vector data.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        for (nat_t i = 0; i < dim; i++)
+            set(i, input.load());
+    }
+    /** Store vector data.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        for (nat_t i = 0; i < dim; i++)
+            output.store(get(i));
+    }
+public:
+    /** Print vector to the given stream.
+     * @param ostr Output stream
+    **/
+    void print(::std::ostream& ostr) const {
+        ostr << "{ " << get(0);
+        for (nat_t i = 1; i < dim; i++)
+            ostr << ", " << get(i);
+        ostr << " }";
+    }
+};
+
+/** Indices of the nonzero coordinates of a vector.
+ * @param dim Vector dimension
+**/
+template<nat_t dim> class Support final {
+public:
+    nat_t index[dim]; // Indices of the nonzero coordinates, in increasing order
+    val_t value[dim]; // Nonzero coordinates, packed
+    nat_t count;      // Number of nonzero coordinates
+    bool  whole;      // Whether 'count' covers the whole vector (scan not given up)
+public:
+    /** Build an empty support, to be filled by 'scan'.
+    **/
+    Support(): count(0), whole(false) {}
+public:
+    /** Scan a vector, giving up as soon as it has more nonzero coordinates than the given limit.
+     * @param vector Vector to scan
+     * @param limit  Maximal number of nonzero coordinates of interest
+     * @return Whether the whole vector was scanned, i.e. it has at most 'limit' nonzero coordinates
+    **/
+    bool scan(Vector<dim> const& vector, nat_t limit) {
+        val_t const* data = vector.data();
+        count = 0;
+        whole = false;
+        for (nat_t i = 0; i < dim; i++) {
+            if (data[i] != 0) {
+                if (unlikely(count == limit)) // Too dense to be of any use
+                    return false;
+                index[count] = i;
+                value[count++] = data[i];
+            }
+        }
+        whole = true;
+        return true;
+    }
+public:
+    /** Scalar product with a full vector.
+     * @param x Full vector data
+     * @return Scalar product
+    **/
+    val_t dot(val_t const* x) const {
+        val_t part[4] = { 0, 0, 0, 0 }; // Independent partial sums, not bound by the add latency
+        nat_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            part[0] += x[index[i]]     * value[i];
+            part[1] += x[index[i + 1]] * value[i + 1];
+            part[2] += x[index[i + 2]] * value[i + 2];
+            part[3] += x[index[i + 3]] * value[i + 3];
+        }
+        for (; i < count; i++)
+            part[0] += x[index[i]] * value[i];
+        return (part[0] + part[1]) + (part[2] + part[3]);
+    }
+};
+
+/** Compile-time loop, fully unrolled.
+ * @param count Number of iterations
+**/
+template<nat_t count> class Unroll final {
+private:
+    /** Call the function with each index, in increasing order.
+     * @param func Function to call
+    **/
+    template<class Func, nat_t... ids> static void apply(Func&& func, ::std::integer_sequence<nat_t, ids...>) {
+        int expand[] = { 0, (func(ids), 0)... }; // Braced initializers are evaluated in order
+        static_cast<void>(expand);
+    }
+public:
+    /** Call the function with each index in [0, count), in increasing order.
+     * @param func Function to call, with the index
+    **/
+    template<class Func> static void apply(Func&& func) {
+        apply(func, ::std::make_integer_sequence<nat_t, count>());
+    }
+};
+
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Simple vector ▔
+// ▁ Optimizers ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+
+/** Learning rate schedule, evaluated once per epoch.
+**/
+class Schedule final {
+private:
+    /** Schedule shape.
+    **/
+    enum class shape { constant, step, cosine };
+private:
+    shape kind;   // Schedule shape
+    val_t eta;    // Initial (maximal) learning rate
+    val_t param;  // Decay factor (step) or minimal learning rate (cosine)
+    nat_t period; // Period, in epochs
+private:
+    /** Private constructor, see the static builders.
+    **/
+    Schedule(shape kind, val_t eta, val_t param, nat_t period): kind(kind), eta(eta), param(param), period(period > 0 ? period : 1) {}
+public:
+    /** Constant learning rate, implicit conversion.
+     * @param eta Learning rate
+    **/
+    Schedule(val_t eta): Schedule(shape::constant, eta, 0, 1) {}
+    /** Step decay: 'eta * factor ^ (epoch / period)'.
+     * @param eta    Initial learning rate
+     * @param factor Decay factor
+     * @param period Epochs between two decays
+     * @return Schedule
+    **/
+    static Schedule step(val_t eta, val_t factor, nat_t period) {
+        return Schedule(shape::step, eta, factor, period);
+    }
+    /** Cosine annealing from 'eta' down to 'eta_min', restarting every 'period' epochs.
+     * @param eta     Maximal learning rate
+     * @param eta_min Minimal learning rate
+     * @param period  Epochs between two restarts
+     * @return Schedule
+    **/
+    static Schedule cosine(val_t eta, val_t eta_min, nat_t period) {
+        return Schedule(shape::cosine, eta, eta_min, period);
+    }
+public:
+    /** Get the learning rate for the given epoch.
+     * @param epoch Epoch number, starting at 0
+     * @return Learning rate
+    **/
+    val_t operator()(nat_t epoch) const {
+        switch (kind) {
+            case shape::step:
+                return eta * ::std::pow(param, static_cast<val_t>(epoch / period));
+            case shape::cosine: {
+                val_t phase = static_cast<val_t>(epoch % period) / static_cast<val_t>(period);
+                return param + (eta - param) * (val_t(1) + ::std::cos(::std::acos(val_t(-1)) * phase)) / 2;
+            }
+            default:
+                return eta;
+        }
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+namespace Optimizer {
+
+/** Optimizers share the following interface:
+ *   constexpr static bool sparse;     // Whether a zero input always leaves its parameter unchanged
+ *   constexpr static bool concurrent; // Whether updates of distinct parameters may run concurrently, and with 'step'
+ *   void epoch(nat_t epoch); // Called by the training loop before each epoch
+ *   void step();             // Called once per corrected sample, before its updates
+ *   void update(val_t* param, val_t const* input, nat_t count, val_t err); // Move 'param[i]' along 'err * input[i]'
+ *   void bias(val_t* param, val_t err); // Move the bias 'param' along 'err', its input being always 1
+ * 'err * input[i]' is the opposite of the gradient of the error for 'param[i]'.
+ * Sparse optimizers also provide the same update restricted to the nonzero inputs, 'param[index[i]]' along 'err * value[i]':
+ *   void update(val_t* param, val_t const* value, nat_t const* index, nat_t count, val_t err);
+**/
+
+/** Per-parameter state, with the same layout as the parameters of a network.
+ * The state of a parameter is found at the same byte offset as the parameter in the network object, so the state is
+ * bound to the network instance it was built for: parameters of any other instance (e.g. a copy) are rejected.
+ * The state is serialized parameter by parameter, in the order of the network serialization, so that it does not
+ * depend on the object layout of the build.
+ * @param Net   Network type
+ * @param slots Number of state values per parameter
+ * @param Alloc Allocation policy
+**/
+template<class Net, nat_t slots, class Alloc> class Mirror final {
+private:
+    constexpr static size_t length = Allocator::round(sizeof(Net), Allocator::cache_line); // Bytes per slot
+private:
+    Alloc alloc; // Allocator instance
+    Net const& network; // Mirrored network
+    uint8_t const* base; // Network base address
+    uint8_t* state; // State values, zero-initialized
+private:
+    /** Get the state of a parameter.
+     * @param slot  Slot id
+     * @param param Parameter address, in the mirrored network
+     * @return State address
+    **/
+    val_t* locate(nat_t slot, val_t const* param) const {
+        uintptr_t offset = reinterpret_cast<uintptr_t>(param) - reinterpret_cast<uintptr_t>(base); // Wraps around below the base
+        if (unlikely(offset >= sizeof(Net)))
+            throw ::std::logic_error("Optimizer state used with another network than the one it was built for");
+        return reinterpret_cast<val_t*>(state + slot * length + offset);
+    }
+    /** Apply a function to each parameter of the network, in the order of its serialization.
+     * @param func Function to apply, called with the address of each parameter
+    **/
+    template<class Func> void walk(Func&& func) const {
+        network.each([&](auto const& layer) {
+            layer.each([&](auto const& neuron) {
+                val_t const* weight = neuron.weight.data();
+                for (nat_t i = 0; i < neuron.weight.length(); i++)
+                    func(weight + i);
+                func(&neuron.bias);
+            });
+        });
+    }
+    /** Count the parameters of the network.
+     * @return Number of parameters
+    **/
+    nat_t count() const {
+        nat_t count = 0;
+        walk([&](val_t const*) { count++; });
+        return count;
+    }
+public:
+    /** Allocate a zeroed state for the given network.
+     * @param network Network to mirror
+    **/
+    Mirror(Net const& network): alloc(), network(network), base(reinterpret_cast<uint8_t const*>(&network)) {
+        state = static_cast<uint8_t*>(alloc.allocate(slots * length));
+        ::std::fill(state, state + slots * length, uint8_t(0));
+    }
+    /** Copy constructor (deleted).
+    **/
+    Mirror(Mirror const&) = delete;
+    /** Free the state.
+    **/
+    ~Mirror() {
+        alloc.free(static_cast<void*>(state), slots * length);
+    }
+public:
+    /** Get the state of a parameter.
+     * @param slot  Slot id
+     * @param param Parameter address, in the mirrored network
+     * @return State address
+    **/
+    val_t* get(nat_t slot, val_t const* param) {
+        return locate(slot, param);
+    }
+public:
+    /** Load the state, stored for a network with as many parameters.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        if (input.load_index() != count())
+            throw ::std::runtime_error("Optimizer state stored for another network");
+        for (nat_t slot = 0; slot < slots; slot++)
+            walk([&](val_t const* param) { *locate(slot, param) = input.load(); });
+    }
+    /** Store the state, the number of parameters first.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        output.store_index(count());
+        for (nat_t slot = 0; slot < slots; slot++)
+            walk([&](val_t const* param) { output.store(*locate(slot, param)); });
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Plain gradient descent: 'param += eta * err * input'.
+**/
+class Plain final {
+public:
+    constexpr static bool sparse = true;
+    constexpr static bool concurrent = true;
+private:
+    Schedule sched; // Learning rate schedule
+    val_t    eta;   // Current learning rate
+public:
+    /** Constructor.
+     * @param sched Learning rate schedule
+    **/
+    Plain(Schedule const& sched): sched(sched), eta(sched(0)) {}
+public:
+    /** Start a new epoch.
+     * @param epoch Epoch number, starting at 0
+    **/
+    void epoch(nat_t epoch) {
+        eta = sched(epoch);
+    }
+    /** Start a new sample (no-op).
+    **/
+    void step() {}
+    /** Update parameters.
+     * @param param Parameters to update
+     * @param input Input values
+     * @param count Number of parameters
+     * @param err   Error factor
+    **/
+    void update(val_t* param, val_t const* input, nat_t count, val_t err) {
+        val_t const factor = eta * err;
+        for (nat_t i = 0; i < count; i++)
+            param[i] += factor * input[i];
+    }
+    /** Update the parameters of the nonzero inputs.
+     * @param param Parameters to update
+     * @param value Nonzero input values, packed
+     * @param index Indices of the parameters to update
+     * @param count Number of parameters to update
+     * @param err   Error factor
+    **/
+    void update(val_t* param, val_t const* value, nat_t const* index, nat_t count, val_t err) {
+        val_t const factor = eta * err;
+        for (nat_t i = 0; i < count; i++)
+            param[index[i]] += factor * value[i];
+    }
+    /** Update a bias.
+     * @param param Bias to update
+     * @param err   Error factor
+    **/
+    void bias(val_t* param, val_t err) {
+        *param += eta * err;
+    }
+public:
+    /** Load the optimizer state (none).
+    **/
+    void load(Serializer::Input&) {}
+    /** Store the optimizer state (none).
+    **/
+    void store(Serializer::Output&) const {}
+};
+
+/** Heavy-ball momentum: 'v = mu * v + err * input', 'param += eta * v'.
+ * @param Net   Network type
+ * @param Alloc Allocation policy for the velocities
+**/
+template<class Net, class Alloc = Allocator::Heap> class Momentum final {
+public:
+    constexpr static bool sparse = false;
+    constexpr static bool concurrent = true;
+private:
+    Mirror<Net, 1, Alloc> velocity; // Velocities
+    Schedule sched; // Learning rate schedule
+    val_t    eta;   // Current learning rate
+    val_t    mu;    // Momentum factor
+public:
+    /** Constructor.
+     * @param network Network to optimize
+     * @param sched   Learning rate schedule
+     * @param mu      Momentum factor
+    **/
+    Momentum(Net const& network, Schedule const& sched, val_t mu = 0.9): velocity(network), sched(sched), eta(sched(0)), mu(mu) {}
+public:
+    /** Start a new epoch.
+     * @param epoch Epoch number, starting at 0
+    **/
+    void epoch(nat_t epoch) {
+        eta = sched(epoch);
+    }
+    /** Start a new sample (no-op).
+    **/
+    void step() {}
+    /** Update parameters.
+     * @param param Parameters to update
+     * @param input Input values
+     * @param count Number of parameters
+     * @param err   Error factor
+    **/
+    void update(val_t* param, val_t const* input, nat_t count, val_t err) {
+        val_t* v = velocity.get(0, param);
+        for (nat_t i = 0; i < count; i++) {
+            v[i] = mu * v[i] + err * input[i];
+            param[i] += eta * v[i];
+        }
+    }
+    /** Update a bias.
+     * @param param Bias to update
+     * @param err   Error factor
+    **/
+    void bias(val_t* param, val_t err) {
+        val_t const one = 1; // Bias input
+        update(param, &one, 1, err);
+    }
+public:
+    /** Load the optimizer state.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        velocity.load(input);
+    }
+    /** Store the optimizer state.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        velocity.store(output);
+    }
+};
+
+/** Nesterov momentum: 'v = mu * v + g', 'param += eta * (g + mu * v)', with 'g = err * input'.
+ * @param Net   Network type
+ * @param Alloc Allocation policy for the velocities
+**/
+template<class Net, class Alloc = Allocator::Heap> class Nesterov final {
+public:
+    constexpr static bool sparse = false;
+    constexpr static bool concurrent = true;
+private:
+    Mirror<Net, 1, Alloc> velocity; // Velocities
+    Schedule sched; // Learning rate schedule
+    val_t    eta;   // Current learning rate
+    val_t    mu;    // Momentum factor
+public:
+    /** Constructor.
+     * @param network Network to optimize
+     * @param sched   Learning rate schedule
+     * @param mu      Momentum factor
+    **/
+    Nesterov(Net const& network, Schedule const& sched, val_t mu = 0.9): velocity(network), sched(sched), eta(sched(0)), mu(mu) {}
+public:
+    /** Start a new epoch.
+     * @param epoch Epoch number, starting at 0
+    **/
+    void epoch(nat_t epoch) {
+        eta = sched(epoch);
+    }
+    /** Start a new sample (no-op).
+    **/
+    void step() {}
+    /** Update parameters.
+     * @param param Parameters to update
+     * @param input Input values
+     * @param count Number of parameters
+     * @param err   Error factor
+    **/
+    void update(val_t* param, val_t const* input, nat_t count, val_t err) {
+        val_t* v = velocity.get(0, param);
+        for (nat_t i = 0; i < count; i++) {
+            val_t g = err * input[i];
+            v[i] = mu * v[i] + g;
+            param[i] += eta * (g + mu * v[i]);
+        }
+    }
+    /** Update a bias.
+     * @param param Bias to update
+     * @param err   Error factor
+    **/
+    void bias(val_t* param, val_t err) {
+        val_t const one = 1; // Bias input
+        update(param, &one, 1, err);
+    }
+public:
+    /** Load the optimizer state.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        velocity.load(input);
+    }
+    /** Store the optimizer state.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        velocity.store(output);
+    }
+};
+
+/** Adam, or AdamW when given a non-zero (decoupled) weight decay.
+ * @param Net   Network type
+ * @param Alloc Allocation policy for the moments
+**/
+template<class Net, class Alloc = Allocator::Heap> class Adam final {
+public:
+    constexpr static bool sparse = false;
+    constexpr static bool concurrent = false; // Shared bias correction, updated by 'step'
+private:
+    Mirror<Net, 2, Alloc> moments; // First (slot 0) and second (slot 1) moments
+    Schedule sched; // Learning rate schedule
+    val_t    eta;   // Current learning rate
+    val_t    decay; // Decoupled weight decay (0 for Adam)
+    val_t    beta1; // First moment decay
+    val_t    beta2; // Second moment decay
+    val_t    eps;   // Denominator offset
+    val_t    pow1;  // 'beta1 ^ t'
+    val_t    pow2;  // 'beta2 ^ t'
+    val_t    rate;  // Bias-corrected learning rate for the current sample
+private:
+    /** Update the bias-corrected learning rate.
+    **/
+    void correction() {
+        rate = (pow1 < val_t(1) ? eta * ::std::sqrt(val_t(1) - pow2) / (val_t(1) - pow1) : eta);
+    }
+    /** Update parameters, scaling them first.
+     * @param param Parameters to update
+     * @param input Input values
+     * @param count Number of parameters
+     * @param err   Error factor
+     * @param keep  Parameter scale factor (weight decay)
+    **/
+    void advance(val_t* param, val_t const* input, nat_t count, val_t err, val_t keep) {
+        val_t* m = moments.get(0, param);
+        val_t* v = moments.get(1, param);
+        for (nat_t i = 0; i < count; i++) {
+            val_t g = err * input[i];
+            m[i] = beta1 * m[i] + (val_t(1) - beta1) * g;
+            v[i] = beta2 * v[i] + (val_t(1) - beta2) * g * g;
+            param[i] = keep * param[i] + rate * m[i] / (::std::sqrt(v[i]) + eps);
+        }
+    }
+public:
+    /** Constructor.
+     * @param network Network to optimize
+     * @param sched   Learning rate schedule
+     * @param decay   Decoupled weight decay (0 for Adam)
+     * @param beta1   First moment decay
+     * @param beta2   Second moment decay
+     * @param eps     Denominator offset
+    **/
+    Adam(Net const& network, Schedule const& sched, val_t decay = 0, val_t beta1 = 0.9, val_t beta2 = 0.999, val_t eps = 1e-8): moments(network), sched(sched), eta(sched(0)), decay(decay), beta1(beta1), beta2(beta2), eps(eps), pow1(1), pow2(1) {
+        correction();
+    }
+public:
+    /** Start a new epoch.
+     * @param epoch Epoch number, starting at 0
+    **/
+    void epoch(nat_t epoch) {
+        eta = sched(epoch);
+        correction();
+    }
+    /** Start a new sample, update the bias correction.
+    **/
+    void step() {
+        pow1 *= beta1;
+        pow2 *= beta2;
+        correction();
+    }
+    /** Update parameters.
+     * @param param Parameters to update
+     * @param input Input values
+     * @param count Number of parameters
+     * @param err   Error factor
+    **/
+    void update(val_t* param, val_t const* input, nat_t count, val_t err) {
+        advance(param, input, count, err, val_t(1) - eta * decay);
+    }
+    /** Update a bias, never decayed.
+     * @param param Bias to update
+     * @param err   Error factor
+    **/
+    void bias(val_t* param, val_t err) {
+        val_t const one = 1; // Bias input
+        advance(param, &one, 1, err, 1);
+    }
+public:
+    /** Load the optimizer state.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        pow1 = input.load();
+        pow2 = input.load();
+        correction();
+        moments.load(input);
+    }
+    /** Store the optimizer state.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        output.store(pow1);
+        output.store(pow2);
+        moments.store(output);
+    }
+};
+
+/** Keep pruned parameters at zero: the weights which are zero at construction are reset to zero after each update.
+ * @param Net   Network type
+ * @param Optim Wrapped optimizer type
+ * @param Alloc Allocation policy for the mask
+**/
+template<class Net, class Optim, class Alloc = Allocator::Heap> class Masked final {
+public:
+    constexpr static bool sparse = Optim::sparse;
+    constexpr static bool concurrent = Optim::concurrent;
+private:
+    Optim& optim; // Wrapped optimizer
+    Mirror<Net, 1, Alloc> mask; // 1 for live parameters, 0 for pruned ones
+public:
+    /** Constructor.
+     * @param network Network to fine-tune, zero weights are pruned
+     * @param optim   Wrapped optimizer
+    **/
+    Masked(Net const& network, Optim& optim): optim(optim), mask(network) {
+        network.each([this](auto const& layer) {
+            layer.each([this](auto const& neuron) {
+                val_t const* weight = neuron.weight.data();
+                for (nat_t i = 0; i < neuron.weight.length(); i++)
+                    *mask.get(0, weight + i) = (weight[i] != 0 ? 1 : 0);
+                *mask.get(0, &neuron.bias) = 1;
+            });
+        });
+    }
+public:
+    /** Start a new epoch.
+     * @param epoch Epoch number, starting at 0
+    **/
+    void epoch(nat_t epoch) {
+        optim.epoch(epoch);
+    }
+    /** Start a new sample.
+    **/
+    void step() {
+        optim.step();
+    }
+    /** Update parameters, then reset the pruned ones.
+     * @param param Parameters to update
+     * @param input Input values
+     * @param count Number of parameters
+     * @param err   Error factor
+    **/
+    void update(val_t* param, val_t const* input, nat_t count, val_t err) {
+        optim.update(param, input, count, err);
+        val_t const* live = mask.get(0, param);
+        for (nat_t i = 0; i < count; i++)
+            param[i] *= live[i];
+    }
+    /** Update the parameters of the nonzero inputs, then reset the pruned ones.
+     * @param param Parameters to update
+     * @param value Nonzero input values, packed
+     * @param index Indices of the parameters to update
+     * @param count Number of parameters to update
+     * @param err   Error factor
+    **/
+    void update(val_t* param, val_t const* value, nat_t const* index, nat_t count, val_t err) {
+        optim.update(param, value, index, count, err);
+        val_t const* live = mask.get(0, param);
+        for (nat_t i = 0; i < count; i++)
+            param[index[i]] *= live[index[i]];
+    }
+    /** Update a bias, never pruned.
+     * @param param Bias to update
+     * @param err   Error factor
+    **/
+    void bias(val_t* param, val_t err) {
+        optim.bias(param, err);
+    }
+public:
+    /** Load the wrapped optimizer state.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        optim.load(input);
+    }
+    /** Store the wrapped optimizer state.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        optim.store(output);
+    }
+};
+
+} }
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Optimizers ▔
+// ▁ Output stages ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+namespace Stage {
+
+/** Output stages of a network share the following interface:
+ *   constexpr static bool transfert; // Whether the output is the transfert function of the last sums
+ *   template<nat_t dim> static void activate(Vector<dim> const& sums, Vector<dim>& output); // Output from the last sums
+ * In both cases, 'expected - output' is back-propagated from the last sums, through the transfert derivative only if
+ * 'transfert' holds: this is the quadratic error gradient for 'Quadratic', the cross-entropy gradient for 'Softmax'.
+ * Without 'transfert', the last layer only computes its sums, its activation function being skipped altogether.
+**/
+
+/** Transfert function on each output, quadratic error.
+**/
+class Quadratic final {
+public:
+    constexpr static bool transfert = true;
+    /** Compute the output from the last sums (no-op, already computed by the layer).
+    **/
+    template<nat_t dim> static void activate(Vector<dim> const&, Vector<dim>&) {}
+};
+
+/** Softmax over the outputs, cross-entropy error.
+**/
+class Softmax final {
+public:
+    constexpr static bool transfert = false;
+    /** Compute the output from the last sums, numerically stable.
+     * @param sums   Sum of weighted inputs vector
+     * @param output Output vector (probabilities)
+    **/
+    template<nat_t dim> static void activate(Vector<dim> const& sums, Vector<dim>& output) {
+        val_t max = maximum(sums);
+        val_t total = 0;
+        for (nat_t i = 0; i < dim; i++) {
+            val_t value = ::std::exp(sums.get(i) - max);
+            output.set(i, value);
+            total += value;
+        }
+        val_t const inverse = val_t(1) / total;
+        for (nat_t i = 0; i < dim; i++)
+            output.set(i, output.get(i) * inverse);
+    }
+};
+
+} }
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Output stages ▔
+// ▁ Workers ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+
+/** NUMA topology of the machine, as exposed in '/sys/devices/system/node'.
+ * Without NUMA support (or 'STATICNET_NUMA'), the machine is seen as a single node holding every CPU, and pinning is a no-op.
+**/
+class Topology final {
+private:
+    ::std::vector<::std::vector<nat_t>> nodes; // CPUs of each node
+    ::std::vector<nat_t> owners; // Node of each CPU
+private:
+    /** Read a small text file.
+     * @param path File path
+     * @param text Read text (output)
+     * @return True on success, false otherwise
+    **/
+    static bool read(char const* path, ::std::string& text) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        char buffer[4096];
+        ssize_t size = ::read(fd, buffer, sizeof(buffer) - 1);
+        ::close(fd);
+        if (size < 0)
+            return false;
+        text.assign(buffer, static_cast<size_t>(size));
+        return true;
+    }
+public:
+    /** Parse a list of ids in the kernel format (e.g. "0-3,8,10-11").
+     * @param text List to parse
+     * @return Ids, in the list order
+    **/
+    static ::std::vector<nat_t> parse(::std::string const& text) {
+        ::std::vector<nat_t> ids;
+        char const* cursor = text.c_str();
+        while (*cursor >= '0' && *cursor <= '9') {
+            char* end;
+            nat_t first = static_cast<nat_t>(::std::strtoul(cursor, &end, 10));
+            nat_t last  = first;
+            if (*end == '-')
+                last = static_cast<nat_t>(::std::strtoul(end + 1, &end, 10));
+            for (nat_t id = first; id <= last; id++)
+                ids.push_back(id);
+            cursor = (*end == ',' ? end + 1 : end);
+        }
+        return ids;
+    }
+    /** Pin the calling thread to a set of CPUs (best effort).
+     * @param cpus CPU ids
+    **/
+    static void pin(::std::vector<nat_t> const& cpus) {
+#if STATICNET_NUMA
+        ::cpu_set_t set;
+        CPU_ZERO(&set);
+        for (nat_t cpu: cpus)
+            CPU_SET(static_cast<int>(cpu), &set);
+        ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+#else
+        static_cast<void>(cpus);
+#endif
+    }
+public:
+    /** Discover the topology.
+    **/
+    Topology(): nodes(), owners() {
+#if STATICNET_NUMA
+        ::std::string text;
+        if (read("/sys/devices/system/node/online", text)) {
+            for (nat_t node: parse(text)) {
+                ::std::string path = "/sys/devices/system/node/node" + ::std::to_string(node) + "/cpulist";
+                if (!read(path.c_str(), text))
+                    continue;
+                ::std::vector<nat_t> cpus = parse(text);
+                if (!cpus.empty()) // Memory-only nodes are left out
+                    nodes.push_back(::std::move(cpus));
+            }
+        }
+#endif
+        if (nodes.empty()) { // No NUMA support, single node
+            nat_t count = ::std::max<nat_t>(::std::thread::hardware_concurrency(), 1);
+            nodes.emplace_back();
+            for (nat_t cpu = 0; cpu < count; cpu++)
+                nodes.back().push_back(cpu);
+        }
+        for (nat_t node = 0; node < nodes.size(); node++) {
+            for (nat_t cpu: nodes[node]) {
+                if (cpu >= owners.size())
+                    owners.resize(cpu + 1, 0);
+                owners[cpu] = node;
+            }
+        }
+    }
+public:
+    /** Return the number of nodes (with at least one CPU).
+     * @return Number of nodes
+    **/
+    nat_t size() const {
+        return static_cast<nat_t>(nodes.size());
+    }
+    /** Get the CPUs of a node.
+     * @param node Node index, in [0, size())
+     * @return CPU ids
+    **/
+    ::std::vector<nat_t> const& cpus(nat_t node) const {
+        return nodes[node];
+    }
+    /** Get the node of a CPU.
+     * @param cpu CPU id
+     * @return Node index, in [0, size())
+    **/
+    nat_t node(nat_t cpu) const {
+        return cpu < owners.size() ? owners[cpu] : 0;
+    }
+    /** Get the node the calling thread is currently running on.
+     * @return Node index, in [0, size())
+    **/
+    nat_t local() const {
+#if STATICNET_NUMA
+        int cpu = ::sched_getcpu();
+        return cpu < 0 ? 0 : node(static_cast<nat_t>(cpu));
+#else
+        return 0;
+#endif
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Persistent pool of worker threads, running jobs split in parts with the calling thread.
+ * Workers poll for a new job for a while before sleeping, so that back-to-back jobs (e.g. successive layers) are
+ * dispatched without any system call. A job returns once every part is done, which is the barrier between layers.
+**/
+class Workers final {
+private:
+    constexpr static nat_t spin_count  = 1 << 12; // Polls before yielding
+    constexpr static nat_t sleep_count = 1 << 16; // Polls before sleeping
+private:
+    using Task = void (*)(void const*, nat_t, nat_t); // Job trampoline: context, part, parts
+private:
+    alignas(Allocator::cache_line) ::std::atomic<nat_t> generation; // Bumped for each job (and to stop)
+    alignas(Allocator::cache_line) ::std::atomic<nat_t> pending;    // Parts still running
+    alignas(Allocator::cache_line) ::std::atomic<nat_t> sleepers;   // Workers sleeping (or about to)
+    Task task;           // Current job trampoline
+    void const* context; // Current job
+    nat_t parts;         // Number of parts of each job (workers and calling thread)
+    bool stop;           // Whether the workers must exit
+    ::std::mutex lock;   // Lock for sleeping workers
+    ::std::condition_variable cond; // Wakes up the sleeping workers
+    ::std::vector<::std::thread> threads; // Worker threads
+private:
+    /** Job trampoline.
+     * @param context Job to run
+     * @param part    Part to run
+     * @param parts   Number of parts
+    **/
+    template<class Func> static void invoke(void const* context, nat_t part, nat_t parts) {
+        (*static_cast<Func const*>(context))(part, parts);
+    }
+    /** Wait for the given generation to change.
+     * @param seen Last seen generation
+     * @return New generation
+    **/
+    nat_t wait(nat_t seen) {
+        for (nat_t i = 0; i < sleep_count; i++) {
+            nat_t current = generation.load(::std::memory_order_acquire);
+            if (current != seen)
+                return current;
+            if (i >= spin_count)
+                ::std::this_thread::yield();
+        }
+        ::std::unique_lock<::std::mutex> guard(lock);
+        sleepers.fetch_add(1);
+        nat_t current;
+        cond.wait(guard, [&]() { return (current = generation.load()) != seen; });
+        sleepers.fetch_sub(1);
+        return current;
+    }
+    /** Worker thread entry point.
+     * @param part Part run by this worker
+    **/
+    void run(nat_t part) {
+        nat_t seen = 0;
+        while (true) {
+            seen = wait(seen);
+            if (stop)
+                return;
+            task(context, part, parts);
+            pending.fetch_sub(1, ::std::memory_order_release);
+        }
+    }
+public:
+    /** Start the workers.
+     * @param count Number of worker threads, the calling thread being an additional participant
+     * @param first First CPU to pin the workers to, one per CPU (optional, a negative value for no pinning)
+    **/
+    Workers(nat_t count, int first = -1): generation(0), pending(0), sleepers(0), task(null), context(null), parts(count + 1), stop(false), lock(), cond(), threads() {
+        nat_t cpus = ::std::thread::hardware_concurrency();
+        threads.reserve(count);
+        for (nat_t i = 0; i < count; i++) {
+            threads.emplace_back([this, i, first, cpus]() {
+                if (first >= 0 && cpus > 0)
+                    Topology::pin({ (static_cast<nat_t>(first) + i) % cpus });
+                run(i + 1);
+            });
+        }
+    }
+    /** Start the workers, each one pinned to its own CPU.
+     * @param cpus CPU of each worker thread, the calling thread being an additional participant
+    **/
+    Workers(::std::vector<nat_t> const& cpus): generation(0), pending(0), sleepers(0), task(null), context(null), parts(cpus.size() + 1), stop(false), lock(), cond(), threads() {
+        threads.reserve(cpus.size());
+        for (nat_t i = 0; i < cpus.size(); i++) {
+            threads.emplace_back([this, i, cpu = cpus[i]]() {
+                Topology::pin({ cpu });
+                run(i + 1);
+            });
+        }
+    }
+    /** Copy constructor (deleted).
+    **/
+    Workers(Workers const&) = delete;
+    /** Stop and join the workers.
+    **/
+    ~Workers() {
+        stop = true;
+        generation.fetch_add(1);
+        {
+            ::std::lock_guard<::std::mutex> guard(lock);
+        }
+        cond.notify_all();
+        for (auto& thread: threads)
+            thread.join();
+    }
+public:
+    /** Run a job, split in 'size() + 1' parts, the calling thread running part 0; returns once every part is done.
+     * Jobs must not be submitted concurrently.
+     * @param func Job, called with the part id and the number of parts
+    **/
+    template<class Func> void run(Func const& func) {
+        if (parts == 1) {
+            func(0, 1);
+            return;
+        }
+        task    = &invoke<Func>;
+        context = static_cast<void const*>(&func);
+        pending.store(parts - 1, ::std::memory_order_relaxed);
+        generation.fetch_add(1); // Publishes the job
+        if (sleepers.load() > 0) {
+            { // Sleeping workers are either waiting or will see the new generation
+                ::std::lock_guard<::std::mutex> guard(lock);
+            }
+            cond.notify_all();
+        }
+        func(0, parts);
+        for (nat_t i = 0; pending.load(::std::memory_order_acquire) != 0; i++) {
+            if (i >= spin_count)
+                ::std::this_thread::yield();
+        }
+    }
+    /** Return the number of worker threads.
+     * @return Number of worker threads
+    **/
+    nat_t size() const {
+        return parts - 1;
+    }
+public:
+    /** Get the contiguous range of elements of a part.
+     * @param count Number of elements
+     * @param part  Part id
+     * @param parts Number of parts
+     * @return Range [begin, end) of the part
+    **/
+    static ::std::pair<nat_t, nat_t> range(nat_t count, nat_t part, nat_t parts) {
+        return { count * part / parts, count * (part + 1) / parts };
+    }
+};
+
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Workers ▔
+// ▁ Timing ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+namespace Timing {
+
+/** Latency instrumentation, compiled in when 'STATICNET_TIMING' is defined only.
+ * Timers read the time-stamp counter where available, and feed log-linear histograms (HDR-style: a fixed relative
+ * precision of 1/32 over the whole range) with relaxed atomic increments, so that concurrent callers may share them.
+**/
+
+using tick_t = uint64_t; // Timer ticks
+
+/** Read the timer.
+ * @return Current tick count
+**/
+static inline tick_t now() {
+#if defined(STATICNET_TIMING) && (defined(__x86_64__) || defined(__i386__))
+    return static_cast<tick_t>(__rdtsc());
+#else
+    return static_cast<tick_t>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(::std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/** Get the duration of a tick, calibrated once against the steady clock (for about 10 ms).
+ * @return Duration of a tick, in ns
+**/
+static inline double tick_ns() {
+#if defined(STATICNET_TIMING) && (defined(__x86_64__) || defined(__i386__))
+    static double const duration = []() {
+        auto  start = ::std::chrono::steady_clock::now();
+        tick_t first = now();
+        ::std::this_thread::sleep_for(::std::chrono::milliseconds(10));
+        tick_t last = now();
+        ::std::chrono::duration<double, ::std::nano> elapsed = ::std::chrono::steady_clock::now() - start;
+        return last > first ? elapsed.count() / static_cast<double>(last - first) : 1.;
+    }();
+    return duration;
+#else
+    return 1.;
+#endif
+}
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Log-linear histogram of durations.
+**/
+class Histogram final {
+private:
+    constexpr static nat_t sub_bits  = 5; // Bits of precision kept in each octave
+    constexpr static nat_t sub_count = 1 << sub_bits; // Buckets per octave
+    constexpr static nat_t linear    = 2 * sub_count; // Values recorded exactly
+    constexpr static nat_t buckets   = linear + (64 - sub_bits - 1) * sub_count; // Number of buckets
+private:
+    ::std::atomic<uint64_t> counts[buckets]; // Number of values in each bucket
+    ::std::atomic<uint64_t> total; // Number of values
+private:
+    /** Get the bucket of a value.
+     * @param value Value to classify
+     * @return Bucket index
+    **/
+    static nat_t bucket(tick_t value) {
+        if (value < linear)
+            return static_cast<nat_t>(value);
+        nat_t shift = 63 - static_cast<nat_t>(__builtin_clzll(value)) - sub_bits; // 'value >> shift' in [sub_count, linear)
+        return linear + (shift - 1) * sub_count + static_cast<nat_t>(value >> shift) - sub_count;
+    }
+    /** Get the middle value of a bucket.
+     * @param index Bucket index
+     * @return Middle value
+    **/
+    static tick_t middle(nat_t index) {
+        if (index < linear)
+            return index;
+        nat_t shift = (index - linear) / sub_count + 1;
+        tick_t base = static_cast<tick_t>((index - linear) % sub_count + sub_count) << shift;
+        return base + (tick_t(1) << (shift - 1));
+    }
+public:
+    /** Empty histogram constructor.
+    **/
+    Histogram(): total(0) {
+        for (nat_t i = 0; i < buckets; i++)
+            counts[i].store(0, ::std::memory_order_relaxed);
+    }
+public:
+    /** Record a duration.
+     * @param value Duration, in ticks
+    **/
+    void record(tick_t value) {
+        counts[bucket(value)].fetch_add(1, ::std::memory_order_relaxed);
+        total.fetch_add(1, ::std::memory_order_relaxed);
+    }
+    /** Forget every recorded duration.
+    **/
+    void reset() {
+        for (nat_t i = 0; i < buckets; i++)
+            counts[i].store(0, ::std::memory_order_relaxed);
+        total.store(0, ::std::memory_order_relaxed);
+    }
+    /** Return the number of recorded durations.
+     * @return Number of durations
+    **/
+    uint64_t count() const {
+        return total.load(::std::memory_order_relaxed);
+    }
+    /** Get a quantile of the recorded durations.
+     * @param q Quantile, in [0, 1]
+     * @return Duration at the given quantile, in ticks (0 if none recorded)
+    **/
+    tick_t quantile(double q) const {
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count()));
+        uint64_t seen = 0;
+        tick_t last = 0;
+        for (nat_t i = 0; i < buckets; i++) {
+            uint64_t here = counts[i].load(::std::memory_order_relaxed);
+            if (here == 0)
+                continue;
+            last = middle(i);
+            seen += here;
+            if (seen > rank)
+                break;
+        }
+        return last;
+    }
+};
+
+/** Scoped timer, recording its lifetime.
+**/
+class Scope final {
+private:
+    Histogram& histogram; // Histogram to feed
+    tick_t start; // Tick count at construction
+public:
+    /** Start the timer.
+     * @param histogram Histogram to feed
+    **/
+    Scope(Histogram& histogram): histogram(histogram), start(now()) {}
+    /** Copy constructor (deleted).
+    **/
+    Scope(Scope const&) = delete;
+    /** Stop the timer, record the duration.
+    **/
+    ~Scope() {
+        histogram.record(now() - start);
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Named histograms, in creation order; histograms are never destroyed.
+**/
+class Registry final {
+private:
+    ::std::mutex lock; // Registry lock
+    ::std::vector<::std::pair<::std::string, ::std::unique_ptr<Histogram>>> entries; // Named histograms
+private:
+    /** Empty registry constructor.
+    **/
+    Registry(): lock(), entries() {}
+public:
+    /** Get the process-wide registry.
+     * @return Registry instance
+    **/
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+public:
+    /** Get a histogram by name, created if needed.
+     * @param name Histogram name
+     * @return Histogram
+    **/
+    Histogram& get(::std::string const& name) {
+        ::std::lock_guard<::std::mutex> guard(lock);
+        for (auto& entry: entries) {
+            if (entry.first == name)
+                return *entry.second;
+        }
+        entries.emplace_back(name, ::std::unique_ptr<Histogram>(new Histogram()));
+        return *entries.back().second;
+    }
+    /** Forget every recorded duration.
+    **/
+    void reset() {
+        ::std::lock_guard<::std::mutex> guard(lock);
+        for (auto& entry: entries)
+            entry.second->reset();
+    }
+    /** Print every non-empty histogram, as quantiles in ns.
+     * @param ostr Output stream
+    **/
+    void dump(::std::ostream& ostr) {
+        ::std::lock_guard<::std::mutex> guard(lock);
+        double scale = tick_ns();
+        ostr << "name\tcount\tp50\tp90\tp99\tp99.9\tmax (ns)" << ::std::endl;
+        for (auto& entry: entries) {
+            Histogram const& histogram = *entry.second;
+            if (histogram.count() == 0)
+                continue;
+            ostr << entry.first << "\t" << histogram.count();
+            for (double q: { 0.5, 0.9, 0.99, 0.999, 1. })
+                ostr << "\t" << static_cast<uint64_t>(static_cast<double>(histogram.quantile(q)) * scale);
+            ostr << ::std::endl;
+        }
+    }
+};
+
+/** Build a histogram name from a kind and dimensions, e.g. "layer 784-98".
+ * @param kind Kind of the timed object
+ * @param dims Dimensions of the timed object
+ * @return Histogram name
+**/
+static inline ::std::string name(char const* kind, ::std::initializer_list<nat_t> dims) {
+    ::std::string res(kind);
+    char sep = ' ';
+    for (nat_t dim: dims) {
+        res += sep;
+        res += ::std::to_string(dim);
+        sep = '-';
+    }
+    return res;
+}
+
+}
+}
+
+/** Time the rest of the enclosing scope, once per scope, when 'STATICNET_TIMING' is defined.
+ * @param name Histogram name, evaluated at the first call only
+**/
+#undef timed_scope
+#ifdef STATICNET_TIMING
+    #define timed_scope(name) \
+        static ::StaticNet::Timing::Histogram& timed_histogram = ::StaticNet::Timing::Registry::instance().get(name); \
+        ::StaticNet::Timing::Scope timed_guard(timed_histogram)
+#else
+    #define timed_scope(name)
+#endif
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Timing ▔
+// ▁ Neural Network ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+
+/** Single neuron with synapses.
+ * @param input_dim Input vector dimension
+**/
+template<nat_t input_dim> class Neuron final {
+    static_assert(input_dim > 0, "Invalid input vector dimension");
+public:
+    Vector<input_dim> weight; // Input weight vector
+    val_t bias; // Bias
+public:
+    /** Randomize the weight vector.
+     * @param rand Randomizer to use
+    **/
+    void randomize(Randomizer& rand) {
+        rand.fill(weight.data(), input_dim);
+        bias = rand.get();
+    }
+    /** Randomize the weight vector from the given position of a counter-based stream, as 'randomize' would from there.
+     * @param rand  Counter-based randomizer to use
+     * @param first Stream position of the first weight
+    **/
+    template<class Rand> void randomize(Rand const& rand, uint64_t first) {
+        rand.generate(weight.data(), input_dim, first, bias); // Bias right after the weights, from the same batch if possible
+    }
+    /** Compute the output of the neuron.
+     * @param input   Input vector
+     * @param act     Activation function
+     * @param out_sum Sum of weighted inputs (optional)
+     * @return Output scalar
+    **/
+    template<class Act> val_t compute(Vector<input_dim> const& input, Act const& act, val_t* out_sum = null) const {
+        val_t sum = weight * input + bias;
+        if (out_sum)
+            *out_sum = sum;
+        return act(sum);
+    }
+    /** Compute the output of the neuron, only from the nonzero inputs.
+     * @param input   Input vector
+     * @param support Support of the input vector
+     * @param act     Activation function
+     * @param out_sum Sum of weighted inputs (optional)
+     * @return Output scalar
+    **/
+    template<class Act> val_t compute(Vector<input_dim> const& input, Support<input_dim> const& support, Act const& act, val_t* out_sum = null) const {
+        val_t sum = support.dot(weight.data()) + bias;
+        if (out_sum)
+            *out_sum = sum;
+        return act(sum);
+    }
+    /** Correct the weight vector of the neuron.
+     * @param input Input vector
+     * @param sum   Sum of weighted inputs
+     * @param error Sum of weighted errors
+     * @param act   Activation function
+     * @param optim Optimizer to use
+     * @param limit Weight absolute value limit (optional, <= 0 for none)
+     * @param derive Whether the error goes through the activation derivative
+     * @return Error scalar
+    **/
+    template<bool derive = true, class Act, class Optim> val_t correct(Vector<input_dim> const& input, val_t sum, val_t error, Act const& act, Optim& optim, val_t limit = 0) {
+        val_t err = (derive ? error * act.diff(sum) : error);
+        optim.update(weight.data(), input.data(), input_dim, err);
+        if (limit > 0) { // Limit exists
+            for (nat_t i = 0; i < input_dim; i++) {
+                val_t update = weight.get(i);
+                if (update > limit) {
+                    weight.set(i, limit);
+                } else if (update < -limit) {
+                    weight.set(i, -limit);
+                }
+            }
+        }
+        optim.bias(&bias, err);
+        return err;
+    }
+    /** Correct the weight vector of the neuron, only the weights of the nonzero inputs.
+     * @param input   Input vector
+     * @param support Support of the input vector
+     * @param sum     Sum of weighted inputs
+     * @param error   Sum of weighted errors
+     * @param act     Activation function
+     * @param optim   Optimizer to use, must be sparse
+     * @param limit   Weight absolute value limit (optional, <= 0 for none)
+     * @param derive  Whether the error goes through the activation derivative
+     * @return Error scalar
+    **/
+    template<bool derive = true, class Act, class Optim> val_t correct(Vector<input_dim> const& input, Support<input_dim> const& support, val_t sum, val_t error, Act const& act, Optim& optim, val_t limit = 0) {
+        static_assert(Optim::sparse, "Optimizer cannot skip zero inputs");
+        val_t err = (derive ? error * act.diff(sum) : error);
+        optim.update(weight.data(), support.value, support.index, support.count, err);
+        if (limit > 0) { // Limit exists, only touched weights may exceed it
+            val_t* w = weight.data();
+            for (nat_t i = 0; i < support.count; i++) {
+                val_t& update = w[support.index[i]];
+                if (update > limit) {
+                    update = limit;
+                } else if (update < -limit) {
+                    update = -limit;
+                }
+            }
+        }
+        optim.bias(&bias, err);
+        return err;
+    }
+    /** Correct the weight vector of the neuron, plain gradient descent.
+     * @param input Input vector
+     * @param sum   Sum of weighted inputs
+     * @param error Sum of weighted errors
+     * @param act   Activation function
+     * @param eta   Correction factor
+     * @param limit Weight absolute value limit (optional, <= 0 for none)
+     * @return Error scalar
+    **/
+    template<class Act> val_t correct(Vector<input_dim> const& input, val_t sum, val_t error, Act const& act, val_t eta, val_t limit = 0) {
+        Optimizer::Plain optim(eta);
+        return correct(input, sum, error, act, optim, limit);
+    }
+public:
+    /** Return the size of the structure.
+     * @return Size of the structure, in bytes
+    **/
+    static constexpr size_t size() {
+        return decltype(weight)::size() + sizeof(val_t);
+    }
+    /** Load neuron data.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        weight.load(input);
+        bias = input.load();
+    }
+    /** Store vector data.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        weight.store(output);
+        output.store(bias);
+    }
+public:
+    /** Print neuron weights to the given stream.
+     * @param ostr Output stream
+    **/
+    void print(::std::ostream& ostr) const {
+        ostr << "{ ";
+        weight.print(ostr);
+        ostr << ", " << bias << " }";
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Layer of neurons.
+ * @param input_dim  Input vector dimension
+ * @param output_dim Output vector dimension
+ * @param Act        Activation function
+**/
+template<nat_t input_dim, nat_t output_dim, class Act = Activation::Table> class Layer final {
+    static_assert(input_dim > 0, "Invalid input vector dimension");
+    static_assert(output_dim > 0, "Invalid output vector dimension");
+private:
+    constexpr static nat_t sparse_dim   = 64; // Minimal input dimension to look for zero inputs
+    constexpr static nat_t sparse_ratio = 3;  // Sparse forward kernel used with at most 1 nonzero input out of 'sparse_ratio'
+    constexpr static nat_t update_ratio = 8;  // Sparse updates used with at most 1 nonzero input out of 'update_ratio'
+    constexpr static nat_t sparse_block = 8;  // Neurons sharing each load of the input support
+    constexpr static nat_t unroll_size  = 64; // Layers with at most this many weights use fully unrolled kernels
+    constexpr static nat_t split_size   = 1 << 15; // Layers with at least this many weights are split between workers
+    constexpr static nat_t split_block  = Allocator::cache_line / sizeof(val_t); // Granularity of the split, in neurons (no false sharing on the outputs)
+private:
+    Act act; // Activation function to use
+    Neuron<input_dim> neurons[output_dim]; // Neurons
+public:
+    /** Layer constructor, for table-free activation functions.
+    **/
+    Layer(): act() {}
+    /** Layer constructor.
+     * @param trans Transfert function to use
+    **/
+    Layer(Transfert const& trans): act(trans) {}
+public:
+    /** Randomize the layer.
+     * @param rand Randomizer to use
+    **/
+    void randomize(Randomizer& rand) {
+        for (nat_t i = 0; i < output_dim; i++)
+            neurons[i].randomize(rand);
+    }
+    /** Randomize the layer from the given position of a counter-based stream, the neurons being split between the workers.
+     * The result is the one of 'randomize' from there, whatever the number of workers.
+     * @param rand    Counter-based randomizer to use
+     * @param first   Stream position of the first weight
+     * @param workers Workers to use
+    **/
+    template<class Rand> void randomize(Rand const& rand, uint64_t first, Workers& workers) {
+        workers.run([&](nat_t id, nat_t parts) {
+            auto range = Workers::range(output_dim, id, parts);
+            for (nat_t i = range.first; i < range.second; i++)
+                neurons[i].randomize(rand, first + static_cast<uint64_t>(i) * (input_dim + 1));
+        });
+    }
+    /** Compute the output vector of the layer.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+    **/
+    void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum = null) const {
+        evaluate(input, output, out_sum, act);
+    }
+    /** Compute the sums of weighted inputs of the layer only, for an output stage replacing the activation function.
+     * @param input Input vector
+     * @param sums  Sum of weighted inputs vector (output)
+    **/
+    void sum(Vector<input_dim> const& input, Vector<output_dim>& sums) const {
+        evaluate(input, sums, null, Activation::Identity());
+    }
+    /** Compute the output vector of the layer, the support of the input being kept for the correction with the same input.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param support Support of the input vector (output)
+    **/
+    void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum, Support<input_dim>& support) const {
+        evaluate(input, output, out_sum, act, support);
+    }
+    /** Compute the sums of weighted inputs of the layer only, the support of the input being kept for the correction with the same input.
+     * @param input   Input vector
+     * @param sums    Sum of weighted inputs vector (output)
+     * @param support Support of the input vector (output)
+    **/
+    void sum(Vector<input_dim> const& input, Vector<output_dim>& sums, Support<input_dim>& support) const {
+        evaluate(input, sums, null, Activation::Identity(), support);
+    }
+    /** Compute the output vector of the layer, the neurons of a wide layer being split between the workers.
+     * Each worker always gets the same neurons, so their weights stay in its cache from one call to the next.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param workers Workers to use
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+    **/
+    void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Workers& workers, Vector<output_dim>* out_sum = null) const {
+        evaluate(input, output, workers, out_sum, act);
+    }
+    /** Compute the sums of weighted inputs of the layer only, the neurons of a wide layer being split between the workers.
+     * @param input   Input vector
+     * @param sums    Sum of weighted inputs vector (output)
+     * @param workers Workers to use
+    **/
+    void sum(Vector<input_dim> const& input, Vector<output_dim>& sums, Workers& workers) const {
+        evaluate(input, sums, workers, null, Activation::Identity());
+    }
+    /** Correct the neurons of the layer, the neuron errors being kept on the stack (pass a vector to the other overload to avoid it).
+     * @param input     Input vector
+     * @param sums      Sum of weighted inputs vector
+     * @param error     Sum of weighted errors vector
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit (optional, <= 0 for none)
+     * @param error_out Sum of weighted errors vector (optional)
+     * @param derive    Whether the errors go through the activation derivative
+    **/
+    template<bool derive = true, class Optim> void correct(Vector<input_dim> const& input, Vector<output_dim> const& sums, Vector<output_dim> const& error, Optim& optim, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        Vector<output_dim> errors; // Neuron errors
+        correct<derive>(input, sums, error, errors, optim, limit, error_out);
+    }
+    /** Correct the neurons of the layer, the neuron errors being stored in the given vector.
+     * @param input     Input vector
+     * @param sums      Sum of weighted inputs vector
+     * @param error     Sum of weighted errors vector
+     * @param errors    Neuron errors vector (output)
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit (optional, <= 0 for none)
+     * @param error_out Sum of weighted errors vector (optional)
+     * @param derive    Whether the errors go through the activation derivative
+    **/
+    template<bool derive = true, class Optim> void correct(Vector<input_dim> const& input, Vector<output_dim> const& sums, Vector<output_dim> const& error, Vector<output_dim>& errors, Optim& optim, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        adjust<derive>(input, null, sums, error, errors, optim, limit, error_out);
+    }
+    /** Correct the neurons of the layer, from the support of the input kept by the computation with the same input.
+     * @param input     Input vector
+     * @param support   Support of the input vector, from 'compute' or 'sum'
+     * @param sums      Sum of weighted inputs vector
+     * @param error     Sum of weighted errors vector
+     * @param errors    Neuron errors vector (output)
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit (optional, <= 0 for none)
+     * @param error_out Sum of weighted errors vector (optional)
+     * @param derive    Whether the errors go through the activation derivative
+    **/
+    template<bool derive = true, class Optim> void correct(Vector<input_dim> const& input, Support<input_dim> const& support, Vector<output_dim> const& sums, Vector<output_dim> const& error, Vector<output_dim>& errors, Optim& optim, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        adjust<derive>(input, &support, sums, error, errors, optim, limit, error_out);
+    }
+    /** Correct the neurons of the layer, plain gradient descent.
+     * @param input     Input vector
+     * @param sums      Sum of weighted inputs vector
+     * @param error     Sum of weighted errors vector
+     * @param eta       Correction factor
+     * @param limit     Weight absolute value limit (optional, <= 0 for none)
+     * @param error_out Sum of weighted errors vector (optional)
+    **/
+    void correct(Vector<input_dim> const& input, Vector<output_dim> const& sums, Vector<output_dim> const& error, val_t eta, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        Optimizer::Plain optim(eta);
+        correct(input, sums, error, optim, limit, error_out);
+    }
+private:
+    /** Correct the neurons of the layer.
+     * @param input     Input vector
+     * @param support   Support of the input vector (null to scan the input)
+     * @param sums      Sum of weighted inputs vector
+     * @param error     Sum of weighted errors vector
+     * @param errors    Neuron errors vector (output)
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit (<= 0 for none)
+     * @param error_out Sum of weighted errors vector (optional)
+    **/
+    template<bool derive, class Optim> void adjust(Vector<input_dim> const& input, Support<input_dim> const* support, Vector<output_dim> const& sums, Vector<output_dim> const& error, Vector<output_dim>& errors, Optim& optim, val_t limit, Vector<input_dim>* error_out) {
+        profiled_scope(Profiling::layer_correct, Timing::name("layer correct", { input_dim, output_dim }), 1);
+        if (!correct_sparse<derive>(input, support, sums, error, errors, optim, limit, ::std::integral_constant<bool, Optim::sparse && input_dim >= sparse_dim>())) {
+            for (nat_t i = 0; i < output_dim; i++)
+                errors.set(i, neurons[i].template correct<derive>(input, sums.get(i), error.get(i), act, optim, limit));
+        }
+        if (error_out && input_dim * output_dim <= unroll_size) { // Error vector asked, tiny layer
+            propagate_unrolled(errors, *error_out);
+        } else if (error_out) { // Error vector asked
+            for (nat_t i = 0; i < input_dim; i++) { // Compute error vector
+                val_t sum = 0; // Sum of weighted error
+                for (nat_t j = 0; j < output_dim; j++)
+                    sum += neurons[j].weight.get(i) * errors.get(j);
+                error_out->set(i, sum);
+            }
+        }
+    }
+    /** Compute the output vector of the layer through the given function.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param fn      Function applied to the sums (the activation function, or the identity for the sums only)
+    **/
+    template<class Fn> void evaluate(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum, Fn const& fn) const {
+        evaluate(input, output, out_sum, fn, ::std::integral_constant<bool, input_dim >= sparse_dim>());
+    }
+    /** Compute the output vector of the layer through the given function, the support of a wide input being scanned for this computation only.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param fn      Function applied to the sums
+    **/
+    template<class Fn> void evaluate(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum, Fn const& fn, ::std::true_type) const {
+        Support<input_dim> support; // Support of the input, for this computation only
+        evaluate(input, output, out_sum, fn, support);
+    }
+    /** Compute the output vector of the layer through the given function, a narrow input never being scanned (no support).
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param fn      Function applied to the sums
+    **/
+    template<class Fn> void evaluate(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum, Fn const& fn, ::std::false_type) const {
+        timed_scope(Timing::name("layer", { input_dim, output_dim }));
+        profiled_scope(Profiling::layer_compute, Timing::name("layer compute", { input_dim, output_dim }), 1);
+        if (input_dim * output_dim <= unroll_size) { // Tiny layer
+            compute_unrolled(input, output, out_sum, fn);
+        } else {
+            compute_dense(input, output, out_sum, 0, output_dim, fn);
+        }
+    }
+    /** Compute the output vector of the layer through the given function, the support of the input being kept.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param fn      Function applied to the sums
+     * @param support Support of the input vector (output)
+    **/
+    template<class Fn> void evaluate(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum, Fn const& fn, Support<input_dim>& support) const {
+        timed_scope(Timing::name("layer", { input_dim, output_dim }));
+        profiled_scope(Profiling::layer_compute, Timing::name("layer compute", { input_dim, output_dim }), 1);
+        bool const sparse = input_dim >= sparse_dim && support.scan(input, input_dim / sparse_ratio); // Look for zero inputs, given up once too many for the sparse kernel
+        if (input_dim * output_dim <= unroll_size) { // Tiny layer
+            compute_unrolled(input, output, out_sum, fn);
+        } else if (sparse) {
+            compute_sparse(input, support, output, out_sum, 0, output_dim, fn);
+        } else {
+            compute_dense(input, output, out_sum, 0, output_dim, fn);
+        }
+    }
+    /** Compute the output vector of the layer through the given function, the neurons of a wide layer being split between the workers.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param workers Workers to use
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param fn      Function applied to the sums
+    **/
+    template<class Fn> void evaluate(Vector<input_dim> const& input, Vector<output_dim>& output, Workers& workers, Vector<output_dim>* out_sum, Fn const& fn) const {
+        if (input_dim * output_dim < split_size || workers.size() == 0) { // Not worth a barrier
+            evaluate(input, output, out_sum, fn);
+            return;
+        }
+        timed_scope(Timing::name("layer", { input_dim, output_dim }));
+        profiled_scope(Profiling::layer_compute, Timing::name("layer compute", { input_dim, output_dim }), 1);
+        split(input, output, workers, out_sum, fn, ::std::integral_constant<bool, input_dim >= sparse_dim>());
+    }
+    /** Get the range of neurons of a part, in whole blocks.
+     * @param id    Part id
+     * @param parts Number of parts
+     * @return First neuron, and past the last neuron of the part
+    **/
+    static ::std::pair<nat_t, nat_t> part(nat_t id, nat_t parts) {
+        auto blocks = Workers::range((output_dim + split_block - 1) / split_block, id, parts);
+        return ::std::make_pair(::std::min(blocks.first * split_block, output_dim), ::std::min(blocks.second * split_block, output_dim));
+    }
+    /** Compute the output vector of the layer between the workers, from the nonzero inputs of a wide input if sparse enough.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param workers Workers to use
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param fn      Function applied to the sums
+    **/
+    template<class Fn> void split(Vector<input_dim> const& input, Vector<output_dim>& output, Workers& workers, Vector<output_dim>* out_sum, Fn const& fn, ::std::true_type) const {
+        Support<input_dim> support; // Support of the input, once for all the workers
+        if (support.scan(input, input_dim / sparse_ratio)) { // Look for zero inputs, given up once too many
+            workers.run([&](nat_t id, nat_t parts) {
+                auto range = part(id, parts);
+                compute_sparse(input, support, output, out_sum, range.first, range.second, fn);
+            });
+            return;
+        }
+        split(input, output, workers, out_sum, fn, ::std::false_type());
+    }
+    /** Compute the output vector of the layer between the workers, from every input.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param workers Workers to use
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param fn      Function applied to the sums
+    **/
+    template<class Fn> void split(Vector<input_dim> const& input, Vector<output_dim>& output, Workers& workers, Vector<output_dim>* out_sum, Fn const& fn, ::std::false_type) const {
+        workers.run([&](nat_t id, nat_t parts) {
+            auto range = part(id, parts);
+            compute_dense(input, output, out_sum, range.first, range.second, fn);
+        });
+    }
+    /** Compute the output vector of the layer, every loop unrolled so that the sums stay in registers.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param fn      Function applied to the sums
+    **/
+    template<class Fn> flatten_calls void compute_unrolled(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum, Fn const& fn) const {
+        Unroll<output_dim>::apply([&](nat_t i) {
+            val_t sum = 0; // Same summation order as 'Neuron::compute'
+            Unroll<input_dim>::apply([&](nat_t j) {
+                sum += neurons[i].weight.get(j) * input.get(j);
+            });
+            sum += neurons[i].bias;
+            output.set(i, fn(sum));
+            if (out_sum)
+                out_sum->set(i, sum);
+        });
+    }
+    /** Compute the error vector of the layer inputs, every loop unrolled.
+     * @param errors    Neuron errors vector
+     * @param error_out Sum of weighted errors vector (output)
+    **/
+    flatten_calls void propagate_unrolled(Vector<output_dim> const& errors, Vector<input_dim>& error_out) const {
+        Unroll<input_dim>::apply([&](nat_t i) {
+            val_t sum = 0; // Sum of weighted error
+            Unroll<output_dim>::apply([&](nat_t j) {
+                sum += neurons[j].weight.get(i) * errors.get(j);
+            });
+            error_out.set(i, sum);
+        });
+    }
+    /** Compute some outputs of the layer.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param begin   First neuron to compute
+     * @param end     Past the last neuron to compute
+     * @param fn      Function applied to the sums
+    **/
+    template<class Fn> void compute_dense(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum, nat_t begin, nat_t end, Fn const& fn) const {
+        if (out_sum) {
+            for (nat_t i = begin; i < end; i++) {
+                val_t sum;
+                output.set(i, neurons[i].compute(input, fn, &sum));
+                out_sum->set(i, sum);
+            }
+        } else {
+            for (nat_t i = begin; i < end; i++)
+                output.set(i, neurons[i].compute(input, fn));
+        }
+    }
+    /** Compute some outputs of the layer, only from the nonzero inputs.
+     * Blocks of neurons are computed together, so that each index/value of the support is loaded once per block.
+     * @param input   Input vector
+     * @param support Support of the input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param begin   First neuron to compute
+     * @param end     Past the last neuron to compute
+     * @param fn      Function applied to the sums
+    **/
+    template<class Fn> void compute_sparse(Vector<input_dim> const& input, Support<input_dim> const& support, Vector<output_dim>& output, Vector<output_dim>* out_sum, nat_t begin, nat_t end, Fn const& fn) const {
+        nat_t i = begin;
+        nat_t const blocked = begin + (end - begin) / sparse_block * sparse_block; // Past the last block of neurons
+        for (; i < blocked; i += sparse_block) {
+            val_t const* weights[sparse_block];
+            val_t sums[sparse_block];
+            for (nat_t b = 0; b < sparse_block; b++) {
+                weights[b] = neurons[i + b].weight.data();
+                sums[b] = neurons[i + b].bias;
+            }
+            for (nat_t k = 0; k < support.count; k++) {
+                nat_t const id = support.index[k];
+                val_t const x  = support.value[k];
+                for (nat_t b = 0; b < sparse_block; b++)
+                    sums[b] += weights[b][id] * x;
+            }
+            for (nat_t b = 0; b < sparse_block; b++) {
+                output.set(i + b, fn(sums[b]));
+                if (out_sum)
+                    out_sum->set(i + b, sums[b]);
+            }
+        }
+        for (; i < end; i++) { // Remaining neurons
+            val_t sum;
+            output.set(i, neurons[i].compute(input, support, fn, &sum));
+            if (out_sum)
+                out_sum->set(i, sum);
+        }
+    }
+    /** Correct the neurons of the layer, only the weights of the nonzero inputs.
+     * @param input   Input vector
+     * @param support Support of the input vector (null to scan the input)
+     * @param sums    Sum of weighted inputs vector
+     * @param error   Sum of weighted errors vector
+     * @param errors  Neuron errors vector (output)
+     * @param optim   Optimizer to use
+     * @param limit   Weight absolute value limit (<= 0 for none)
+     * @return True if corrected, false if the input is too dense
+    **/
+    template<bool derive, class Optim> bool correct_sparse(Vector<input_dim> const& input, Support<input_dim> const* support, Vector<output_dim> const& sums, Vector<output_dim> const& error, Vector<output_dim>& errors, Optim& optim, val_t limit, ::std::true_type) {
+        Support<input_dim> scanned; // Support of the input, if not kept by the computation
+        if (!support) {
+            scanned.scan(input, input_dim / update_ratio);
+            support = &scanned;
+        }
+        if (!support->whole || support->count * update_ratio > input_dim) // Scattered updates slower than vectorized ones
+            return false;
+        for (nat_t i = 0; i < output_dim; i++)
+            errors.set(i, neurons[i].template correct<derive>(input, *support, sums.get(i), error.get(i), act, optim, limit));
+        return true;
+    }
+    /** Sparse correction not available (optimizer or input dimension).
+     * @return False
+    **/
+    template<bool derive, class Optim> bool correct_sparse(Vector<input_dim> const&, Support<input_dim> const*, Vector<output_dim> const&, Vector<output_dim> const&, Vector<output_dim>&, Optim&, val_t, ::std::false_type) {
+        return false;
+    }
+public:
+    /** Return the size of the structure.
+     * @return Size of the structure, in bytes
+    **/
+    static constexpr size_t size() {
+        size_t size = 0;
+        for (nat_t i = 0; i < output_dim; i++)
+            size += Neuron<input_dim>::size();
+        return size;
+    }
+    /** Load layer data.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        for (nat_t i = 0; i < output_dim; i++)
+            neurons[i].load(input);
+    }
+    /** Store vector data.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        for (nat_t i = 0; i < output_dim; i++)
+            neurons[i].store(output);
+    }
+public:
+    /** Get the activation function.
+     * @return Activation function
+    **/
+    Act const& activation() const {
+        return act;
+    }
+    /** Get a neuron.
+     * @param id Neuron id
+     * @return Neuron
+    **/
+    Neuron<input_dim> const& neuron(nat_t id) const {
+        return neurons[id];
+    }
+    /** Get a neuron, writable.
+     * @param id Neuron id
+     * @return Neuron
+    **/
+    Neuron<input_dim>& neuron(nat_t id) {
+        return neurons[id];
+    }
+    /** Apply a function to each neuron.
+     * @param func Function to apply, called with each neuron
+    **/
+    template<class Func> void each(Func&& func) {
+        for (nat_t i = 0; i < output_dim; i++)
+            func(neurons[i]);
+    }
+    /** Apply a function to each neuron, read-only.
+     * @param func Function to apply, called with each neuron
+    **/
+    template<class Func> void each(Func&& func) const {
+        for (nat_t i = 0; i < output_dim; i++)
+            func(neurons[i]);
+    }
+public:
+    /** Read-only layer whose parameters are laid out as by 'store', e.g. in a shared mapping, the activation function being its own.
+    **/
+    class View final {
+    private:
+        Act act; // Activation function to use
+        val_t const* params; // Weights then bias of each neuron (null if not attached)
+    public:
+        /** View constructor, attached to no parameter.
+         * @param trans Transfert function to use
+        **/
+        View(Transfert const& trans): act(trans), params(null) {}
+    public:
+        /** Attach the view to its parameters.
+         * @param params Parameters of the layer, laid out as by 'store'
+         * @return Past the parameters of the layer
+        **/
+        val_t const* attach(val_t const* params) {
+            this->params = params;
+            return params + size() / sizeof(val_t);
+        }
+        /** Compute the output vector of the layer.
+         * @param input  Input vector
+         * @param output Output vector
+        **/
+        void compute(Vector<input_dim> const& input, Vector<output_dim>& output) const {
+            evaluate(input, output, act);
+        }
+        /** Compute the sums of weighted inputs of the layer only.
+         * @param input Input vector
+         * @param sums  Sum of weighted inputs vector (output)
+        **/
+        void sum(Vector<input_dim> const& input, Vector<output_dim>& sums) const {
+            evaluate(input, sums, Activation::Identity());
+        }
+    private:
+        /** Compute the output vector of the layer through the given function.
+         * @param input  Input vector
+         * @param output Output vector
+         * @param fn     Function applied to the sums
+        **/
+        template<class Fn> void evaluate(Vector<input_dim> const& input, Vector<output_dim>& output, Fn const& fn) const {
+            val_t const* neuron = params;
+            for (nat_t i = 0; i < output_dim; i++) {
+                val_t sum = 0; // Same summation order as 'Neuron::compute'
+                for (nat_t j = 0; j < input_dim; j++)
+                    sum += neuron[j] * input.get(j);
+                sum += neuron[input_dim];
+                output.set(i, fn(sum));
+                neuron += input_dim + 1;
+            }
+        }
+    };
+public:
+    /** Print neuron weights to the given stream.
+     * @param ostr Output stream
+    **/
+    void print(::std::ostream& ostr) const {
+        ostr << "{" << ::std::endl << "\t";
+        neurons[0].print(ostr);
+        for (nat_t i = 1; i < output_dim; i++) {
+            ostr << "," << ::std::endl << "\t";
+            neurons[i].print(ostr);
+        }
+        ostr << ::std::endl << "}";
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Convolutional layer, with shared-weight kernels, valid padding and unit stride.
+ * Inputs and outputs are laid out row by row, then column by column, the channels (resp. kernels) of a pixel being
+ * contiguous. Each kernel is stored as a neuron whose inputs are the patch under the kernel (im2col row), so the layer
+ * serializes as a layer of 'kernels' neurons of 'side * side * channels' inputs.
+ * @param height   Input height
+ * @param width    Input width
+ * @param channels Input channels
+ * @param kernels  Number of kernels, i.e. output channels
+ * @param side     Kernel height and width
+ * @param Act      Activation function to use
+**/
+template<nat_t height, nat_t width, nat_t channels, nat_t kernels, nat_t side, class Act = Activation::Table> class ConvLayer final {
+    static_assert(height > 0 && width > 0 && channels > 0 && kernels > 0, "Invalid convolution dimensions");
+    static_assert(side > 0 && side <= height && side <= width, "Invalid kernel side");
+public:
+    constexpr static nat_t out_height = height - side + 1; // Output height
+    constexpr static nat_t out_width  = width - side + 1;  // Output width
+    constexpr static nat_t patch_dim  = side * side * channels; // Inputs per kernel
+    constexpr static nat_t input_dim  = height * width * channels;       // Input vector dimension
+    constexpr static nat_t output_dim = out_height * out_width * kernels; // Output vector dimension
+private:
+    Act act; // Activation function to use
+    Neuron<patch_dim> neurons[kernels]; // Kernels
+public:
+    /** Layer constructor, for table-free activation functions.
+    **/
+    ConvLayer(): act() {}
+    /** Layer constructor.
+     * @param trans Transfert function to use
+    **/
+    ConvLayer(Transfert const& trans): act(trans) {}
+public:
+    /** Randomize the kernels.
+     * @param rand Randomizer to use
+    **/
+    void randomize(Randomizer& rand) {
+        for (nat_t k = 0; k < kernels; k++)
+            neurons[k].randomize(rand);
+    }
+    /** Randomize the kernels from the given position of a counter-based stream, as 'randomize' would from there.
+     * @param rand  Counter-based randomizer to use
+     * @param first Stream position of the first weight
+    **/
+    template<class Rand> void randomize(Rand const& rand, uint64_t first, Workers&) {
+        for (nat_t k = 0; k < kernels; k++)
+            neurons[k].randomize(rand, first + static_cast<uint64_t>(k) * (patch_dim + 1));
+    }
+    /** Compute the output vector of the layer.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+    **/
+    void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum = null) const {
+        evaluate(input, output, out_sum, act);
+    }
+    /** Compute the sums of weighted inputs of the layer only, for an output stage replacing the activation function.
+     * @param input Input vector
+     * @param sums  Sum of weighted inputs vector (output)
+    **/
+    void sum(Vector<input_dim> const& input, Vector<output_dim>& sums) const {
+        evaluate(input, sums, null, Activation::Identity());
+    }
+    /** Compute the output vector of the layer (not split between the workers).
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param workers Ignored
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+    **/
+    void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Workers&, Vector<output_dim>* out_sum = null) const {
+        compute(input, output, out_sum);
+    }
+    /** Compute the sums of weighted inputs of the layer only (not split between the workers).
+     * @param input   Input vector
+     * @param sums    Sum of weighted inputs vector (output)
+     * @param workers Ignored
+    **/
+    void sum(Vector<input_dim> const& input, Vector<output_dim>& sums, Workers&) const {
+        sum(input, sums);
+    }
+    /** Compute the output vector of the layer (no input support kept, the kernels being dense).
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param support Ignored
+    **/
+    void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum, Support<input_dim>&) const {
+        compute(input, output, out_sum);
+    }
+    /** Compute the sums of weighted inputs of the layer only (no input support kept).
+     * @param input   Input vector
+     * @param sums    Sum of weighted inputs vector (output)
+     * @param support Ignored
+    **/
+    void sum(Vector<input_dim> const& input, Vector<output_dim>& sums, Support<input_dim>&) const {
+        sum(input, sums);
+    }
+    /** Correct the kernels of the layer, the output errors being kept on the stack (pass a vector to the other overload to avoid it).
+     * @param input     Input vector
+     * @param sums      Sum of weighted inputs vector
+     * @param error     Sum of weighted errors vector
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses, divided by the layer inputs as the network does (optional, <= 0 for none)
+     * @param error_out Sum of weighted errors vector (optional)
+     * @param derive    Whether the errors go through the activation derivative
+    **/
+    template<bool derive = true, class Optim> void correct(Vector<input_dim> const& input, Vector<output_dim> const& sums, Vector<output_dim> const& error, Optim& optim, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        Vector<output_dim> errors; // Output errors
+        correct<derive>(input, sums, error, errors, optim, limit, error_out);
+    }
+    /** Correct the kernels of the layer, the output errors being stored in the given vector (no use for the input support).
+     * @param input     Input vector
+     * @param support   Ignored
+     * @param sums      Sum of weighted inputs vector
+     * @param error     Sum of weighted errors vector
+     * @param errors    Output errors vector (output)
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses, divided by the layer inputs as the network does (optional, <= 0 for none)
+     * @param error_out Sum of weighted errors vector (optional)
+     * @param derive    Whether the errors go through the activation derivative
+    **/
+    template<bool derive = true, class Optim> void correct(Vector<input_dim> const& input, Support<input_dim> const&, Vector<output_dim> const& sums, Vector<output_dim> const& error, Vector<output_dim>& errors, Optim& optim, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        correct<derive>(input, sums, error, errors, optim, limit, error_out);
+    }
+    /** Correct the kernels of the layer, the output errors being stored in the given vector.
+     * The gradient of each kernel is accumulated over every position, then applied in a single optimizer update.
+     * @param input     Input vector
+     * @param sums      Sum of weighted inputs vector
+     * @param error     Sum of weighted errors vector
+     * @param errors    Output errors vector (output)
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses, divided by the layer inputs as the network does (optional, <= 0 for none)
+     * @param error_out Sum of weighted errors vector (optional)
+     * @param derive    Whether the errors go through the activation derivative
+    **/
+    template<bool derive = true, class Optim> void correct(Vector<input_dim> const& input, Vector<output_dim> const& sums, Vector<output_dim> const& error, Vector<output_dim>& errors, Optim& optim, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        profiled_scope(Profiling::layer_correct, Timing::name("conv correct", { height, width, channels, kernels, side }), 1);
+        Vector<patch_dim> patch;          // Patch under the kernels
+        Vector<patch_dim> grads[kernels]; // Kernel weight gradients
+        val_t biases[kernels];            // Kernel bias gradients
+        for (nat_t k = 0; k < kernels; k++) {
+            grads[k] = Expression::Scalar<patch_dim>(0);
+            biases[k] = 0;
+        }
+        for (nat_t y = 0; y < out_height; y++) {
+            for (nat_t x = 0; x < out_width; x++) {
+                gather(input, y, x, patch);
+                nat_t base = (y * out_width + x) * kernels;
+                for (nat_t k = 0; k < kernels; k++) {
+                    val_t err = (derive ? error.get(base + k) * act.diff(sums.get(base + k)) : error.get(base + k));
+                    errors.set(base + k, err);
+                    grads[k] += patch * err;
+                    biases[k] += err;
+                }
+            }
+        }
+        for (nat_t k = 0; k < kernels; k++) {
+            Neuron<patch_dim>& neuron = neurons[k];
+            optim.update(neuron.weight.data(), grads[k].data(), patch_dim, 1);
+            if (limit > 0) { // Limit exists
+                val_t bound = limit * input_dim / patch_dim; // Each kernel only has 'patch_dim' synapses
+                for (nat_t i = 0; i < patch_dim; i++) {
+                    val_t update = neuron.weight.get(i);
+                    if (update > bound) {
+                        neuron.weight.set(i, bound);
+                    } else if (update < -bound) {
+                        neuron.weight.set(i, -bound);
+                    }
+                }
+            }
+            optim.bias(&neuron.bias, biases[k]);
+        }
+        if (error_out) { // Error vector asked, scattered back through the patches
+            val_t* out = error_out->data();
+            for (nat_t i = 0; i < input_dim; i++)
+                out[i] = 0;
+            for (nat_t y = 0; y < out_height; y++) {
+                for (nat_t x = 0; x < out_width; x++) {
+                    nat_t base = (y * out_width + x) * kernels;
+                    for (nat_t k = 0; k < kernels; k++) {
+                        val_t err = errors.get(base + k);
+                        val_t const* weight = neurons[k].weight.data();
+                        for (nat_t dy = 0; dy < side; dy++) {
+                            val_t* row = out + ((y + dy) * width + x) * channels;
+                            for (nat_t i = 0; i < side * channels; i++)
+                                row[i] += weight[dy * side * channels + i] * err;
+                        }
+                    }
+                }
+            }
+        }
+    }
+private:
+    /** Compute the output vector of the layer through the given function.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+     * @param fn      Function applied to the sums (the activation function, or the identity for the sums only)
+    **/
+    template<class Fn> void evaluate(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum, Fn const& fn) const {
+        timed_scope(Timing::name("conv", { height, width, channels, kernels, side }));
+        profiled_scope(Profiling::layer_compute, Timing::name("conv compute", { height, width, channels, kernels, side }), 1);
+        Vector<patch_dim> patch; // Patch under the kernels
+        for (nat_t y = 0; y < out_height; y++) {
+            for (nat_t x = 0; x < out_width; x++) {
+                gather(input, y, x, patch);
+                nat_t base = (y * out_width + x) * kernels;
+                for (nat_t k = 0; k < kernels; k++) {
+                    val_t sum;
+                    output.set(base + k, neurons[k].compute(patch, fn, &sum));
+                    if (out_sum)
+                        out_sum->set(base + k, sum);
+                }
+            }
+        }
+    }
+    /** Copy the patch under the kernels at the given output position (one im2col row).
+     * @param input Input vector
+     * @param y     Output row
+     * @param x     Output column
+     * @param patch Patch vector (output)
+    **/
+    static void gather(Vector<input_dim> const& input, nat_t y, nat_t x, Vector<patch_dim>& patch) {
+        val_t const* in = input.data();
+        val_t* out = patch.data();
+        for (nat_t dy = 0; dy < side; dy++) { // Each patch row is contiguous in the input
+            val_t const* row = in + ((y + dy) * width + x) * channels;
+            for (nat_t i = 0; i < side * channels; i++)
+                out[dy * side * channels + i] = row[i];
+        }
+    }
+public:
+    /** Return the size of the structure.
+     * @return Size of the structure, in bytes
+    **/
+    static constexpr size_t size() {
+        return kernels * Neuron<patch_dim>::size();
+    }
+    /** Load layer data.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        for (nat_t k = 0; k < kernels; k++)
+            neurons[k].load(input);
+    }
+    /** Store vector data.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        for (nat_t k = 0; k < kernels; k++)
+            neurons[k].store(output);
+    }
+public:
+    /** Get the activation function.
+     * @return Activation function
+    **/
+    Act const& activation() const {
+        return act;
+    }
+    /** Get a kernel.
+     * @param id Kernel id
+     * @return Kernel
+    **/
+    Neuron<patch_dim> const& neuron(nat_t id) const {
+        return neurons[id];
+    }
+    /** Apply a function to each kernel.
+     * @param func Function to apply, called with each kernel
+    **/
+    template<class Func> void each(Func&& func) {
+        for (nat_t k = 0; k < kernels; k++)
+            func(neurons[k]);
+    }
+    /** Apply a function to each kernel, read-only.
+     * @param func Function to apply, called with each kernel
+    **/
+    template<class Func> void each(Func&& func) const {
+        for (nat_t k = 0; k < kernels; k++)
+            func(neurons[k]);
+    }
+public:
+    /** Read-only layer whose kernels are laid out as by 'store', e.g. in a shared mapping, the activation function being its own.
+    **/
+    class View final {
+    private:
+        Act act; // Activation function to use
+        val_t const* params; // Weights then bias of each kernel (null if not attached)
+    public:
+        /** View constructor, attached to no parameter.
+         * @param trans Transfert function to use
+        **/
+        View(Transfert const& trans): act(trans), params(null) {}
+    public:
+        /** Attach the view to its parameters.
+         * @param params Parameters of the layer, laid out as by 'store'
+         * @return Past the parameters of the layer
+        **/
+        val_t const* attach(val_t const* params) {
+            this->params = params;
+            return params + size() / sizeof(val_t);
+        }
+        /** Compute the output vector of the layer.
+         * @param input  Input vector
+         * @param output Output vector
+        **/
+        void compute(Vector<input_dim> const& input, Vector<output_dim>& output) const {
+            evaluate(input, output, act);
+        }
+        /** Compute the sums of weighted inputs of the layer only.
+         * @param input Input vector
+         * @param sums  Sum of weighted inputs vector (output)
+        **/
+        void sum(Vector<input_dim> const& input, Vector<output_dim>& sums) const {
+            evaluate(input, sums, Activation::Identity());
+        }
+    private:
+        /** Compute the output vector of the layer through the given function.
+         * @param input  Input vector
+         * @param output Output vector
+         * @param fn     Function applied to the sums
+        **/
+        template<class Fn> void evaluate(Vector<input_dim> const& input, Vector<output_dim>& output, Fn const& fn) const {
+            Vector<patch_dim> patch; // Patch under the kernels
+            for (nat_t y = 0; y < out_height; y++) {
+                for (nat_t x = 0; x < out_width; x++) {
+                    gather(input, y, x, patch);
+                    nat_t base = (y * out_width + x) * kernels;
+                    val_t const* kernel = params;
+                    for (nat_t k = 0; k < kernels; k++) {
+                        val_t sum = 0; // Same summation order as 'Neuron::compute'
+                        for (nat_t i = 0; i < patch_dim; i++)
+                            sum += kernel[i] * patch.get(i);
+                        sum += kernel[patch_dim];
+                        output.set(base + k, fn(sum));
+                        kernel += patch_dim + 1;
+                    }
+                }
+            }
+        }
+    };
+public:
+    /** Print kernel weights to the given stream.
+     * @param ostr Output stream
+    **/
+    void print(::std::ostream& ostr) const {
+        ostr << "{" << ::std::endl << "\t";
+        neurons[0].print(ostr);
+        for (nat_t k = 1; k < kernels; k++) {
+            ostr << "," << ::std::endl << "\t";
+            neurons[k].print(ostr);
+        }
+        ostr << ::std::endl << "}";
+    }
+};
+
+/** Max-pooling layer, over non-overlapping square windows, without parameters.
+ * Inputs and outputs are laid out as for the convolutional layer.
+ * @param height   Input height
+ * @param width    Input width
+ * @param channels Input channels
+ * @param pool     Window height and width
+**/
+template<nat_t height, nat_t width, nat_t channels, nat_t pool> class PoolLayer final {
+    static_assert(height > 0 && width > 0 && channels > 0, "Invalid pooling dimensions");
+    static_assert(pool > 0 && height % pool == 0 && width % pool == 0, "Window size must divide the input size");
+public:
+    constexpr static nat_t out_height = height / pool; // Output height
+    constexpr static nat_t out_width  = width / pool;  // Output width
+    constexpr static nat_t input_dim  = height * width * channels;          // Input vector dimension
+    constexpr static nat_t output_dim = out_height * out_width * channels; // Output vector dimension
+public:
+    /** Layer constructor.
+    **/
+    PoolLayer() {}
+    /** Layer constructor, transfert function ignored.
+    **/
+    PoolLayer(Transfert const&) {}
+public:
+    /** Randomize the layer (no-op).
+    **/
+    void randomize(Randomizer&) {}
+    /** Randomize the layer from a counter-based stream (no-op).
+    **/
+    template<class Rand> void randomize(Rand const&, uint64_t, Workers&) {}
+    /** Compute the output vector of the layer.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Copy of the output vector (output, optional)
+    **/
+    void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum = null) const {
+        for (nat_t o = 0; o < output_dim; o++) {
+            val_t max = input.get(source(input, o));
+            output.set(o, max);
+            if (out_sum)
+                out_sum->set(o, max);
+        }
+    }
+    /** Compute the output vector of the layer (not split between the workers).
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param workers Ignored
+     * @param out_sum Copy of the output vector (output, optional)
+    **/
+    void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Workers&, Vector<output_dim>* out_sum = null) const {
+        compute(input, output, out_sum);
+    }
+    /** Compute the output vector of the layer, which is also its vector of sums.
+     * @param input Input vector
+     * @param sums  Output vector
+    **/
+    void sum(Vector<input_dim> const& input, Vector<output_dim>& sums) const {
+        compute(input, sums);
+    }
+    /** Compute the output vector of the layer (not split between the workers).
+     * @param input   Input vector
+     * @param sums    Output vector
+     * @param workers Ignored
+    **/
+    void sum(Vector<input_dim> const& input, Vector<output_dim>& sums, Workers&) const {
+        compute(input, sums);
+    }
+    /** Compute the output vector of the layer (no input support kept).
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Copy of the output vector (optional)
+     * @param support Ignored
+    **/
+    void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum, Support<input_dim>&) const {
+        compute(input, output, out_sum);
+    }
+    /** Compute the output vector of the layer, which is also its vector of sums (no input support kept).
+     * @param input   Input vector
+     * @param sums    Output vector
+     * @param support Ignored
+    **/
+    void sum(Vector<input_dim> const& input, Vector<output_dim>& sums, Support<input_dim>&) const {
+        compute(input, sums);
+    }
+    /** Route the errors back to the inputs selected by the forward pass, the output errors being kept on the stack (pass a vector to the other overload to avoid it).
+     * @param input     Input vector
+     * @param sums      Ignored
+     * @param error     Sum of weighted errors vector
+     * @param optim     Ignored (no parameter)
+     * @param limit     Ignored (no parameter)
+     * @param error_out Sum of weighted errors vector (optional)
+    **/
+    template<bool derive = true, class Optim> void correct(Vector<input_dim> const& input, Vector<output_dim> const& sums, Vector<output_dim> const& error, Optim& optim, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        Vector<output_dim> errors; // Output errors
+        correct<derive>(input, sums, error, errors, optim, limit, error_out);
+    }
+    /** Route the errors back to the inputs selected by the forward pass, the output errors being stored in the given vector (no use for the input support).
+     * @param input     Input vector
+     * @param support   Ignored
+     * @param sums      Ignored
+     * @param error     Sum of weighted errors vector
+     * @param errors    Output errors vector (output)
+     * @param optim     Ignored (no parameter)
+     * @param limit     Ignored (no parameter)
+     * @param error_out Sum of weighted errors vector (optional)
+    **/
+    template<bool derive = true, class Optim> void correct(Vector<input_dim> const& input, Support<input_dim> const&, Vector<output_dim> const& sums, Vector<output_dim> const& error, Vector<output_dim>& errors, Optim& optim, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        correct<derive>(input, sums, error, errors, optim, limit, error_out);
+    }
+    /** Route the errors back to the inputs selected by the forward pass, the output errors being stored in the given vector.
+     * @param input     Input vector
+     * @param sums      Ignored
+     * @param error     Sum of weighted errors vector
+     * @param errors    Output errors vector (output)
+     * @param optim     Ignored (no parameter)
+     * @param limit     Ignored (no parameter)
+     * @param error_out Sum of weighted errors vector (optional)
+    **/
+    template<bool derive = true, class Optim> void correct(Vector<input_dim> const& input, Vector<output_dim> const&, Vector<output_dim> const& error, Vector<output_dim>& errors, Optim&, val_t = 0, Vector<input_dim>* error_out = null) {
+        errors = error;
+        if (!error_out)
+            return;
+        for (nat_t i = 0; i < input_dim; i++)
+            error_out->set(i, 0);
+        for (nat_t o = 0; o < output_dim; o++) {
+            nat_t i = source(input, o);
+            error_out->set(i, error_out->get(i) + error.get(o));
+        }
+    }
+private:
+    /** Get the input selected for an output, the first largest one of its window.
+     * @param input Input vector
+     * @param o     Output id
+     * @return Input id
+    **/
+    static nat_t source(Vector<input_dim> const& input, nat_t o) {
+        nat_t c = o % channels;
+        nat_t x = (o / channels) % out_width * pool;
+        nat_t y = (o / channels) / out_width * pool;
+        nat_t best = (y * width + x) * channels + c;
+        for (nat_t dy = 0; dy < pool; dy++) {
+            for (nat_t dx = 0; dx < pool; dx++) {
+                nat_t i = ((y + dy) * width + x + dx) * channels + c;
+                if (input.get(i) > input.get(best))
+                    best = i;
+            }
+        }
+        return best;
+    }
+public:
+    /** Return the size of the structure.
+     * @return Size of the structure, in bytes (no parameter)
+    **/
+    static constexpr size_t size() {
+        return 0;
+    }
+    /** Load layer data (none).
+    **/
+    void load(Serializer::Input&) {}
+    /** Store layer data (none).
+    **/
+    void store(Serializer::Output&) const {}
+    /** Apply a function to each neuron (none).
+    **/
+    template<class Func> void each(Func&&) const {}
+public:
+    /** Read-only layer, for the networks whose parameters are viewed (nothing to attach).
+    **/
+    class View final {
+    private:
+        PoolLayer layer; // Layer, without state
+    public:
+        /** View constructor, transfert function ignored.
+        **/
+        View(Transfert const&): layer() {}
+    public:
+        /** Attach the view to its parameters (none).
+         * @param params Parameters of the layer
+         * @return Past the parameters of the layer, i.e. 'params'
+        **/
+        val_t const* attach(val_t const* params) {
+            return params;
+        }
+        /** Compute the output vector of the layer.
+         * @param input  Input vector
+         * @param output Output vector
+        **/
+        void compute(Vector<input_dim> const& input, Vector<output_dim>& output) const {
+            layer.compute(input, output);
+        }
+        /** Compute the output vector of the layer, which is also its vector of sums.
+         * @param input Input vector
+         * @param sums  Output vector
+        **/
+        void sum(Vector<input_dim> const& input, Vector<output_dim>& sums) const {
+            layer.compute(input, sums);
+        }
+    };
+public:
+    /** Print the layer to the given stream.
+     * @param ostr Output stream
+    **/
+    void print(::std::ostream& ostr) const {
+        ostr << "{}";
+    }
+};
+
+/** Layer type of an activation policy entry.
+ * An activation function stands for a dense layer using it, while a convolutional or pooling layer stands for itself.
+ * @param Entry      Activation policy entry
+ * @param input_dim  Input vector dimension
+ * @param output_dim Output vector dimension
+**/
+template<class Entry, nat_t input_dim, nat_t output_dim> class Kind final {
+public:
+    using type = Layer<input_dim, output_dim, Entry>;
+};
+template<nat_t height, nat_t width, nat_t channels, nat_t kernels, nat_t side, class Act, nat_t input_dim, nat_t output_dim> class Kind<ConvLayer<height, width, channels, kernels, side, Act>, input_dim, output_dim> final {
+public:
+    using type = ConvLayer<height, width, channels, kernels, side, Act>;
+    static_assert(type::input_dim == input_dim && type::output_dim == output_dim, "Convolutional layer dimensions do not match the network ones");
+};
+template<nat_t height, nat_t width, nat_t channels, nat_t pool, nat_t input_dim, nat_t output_dim> class Kind<PoolLayer<height, width, channels, pool>, input_dim, output_dim> final {
+public:
+    using type = PoolLayer<height, width, channels, pool>;
+    static_assert(type::input_dim == input_dim && type::output_dim == output_dim, "Pooling layer dimensions do not match the network ones");
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Intermediate vectors of a network, allocated once and reused by every forward/backward pass.
+ * @param ... Input/output vector dimensions
+**/
+template<nat_t... dims> class Workspace;
+template<nat_t input_dim, nat_t inter_dim, nat_t... output_dim> class Workspace<input_dim, inter_dim, output_dim...> final {
+    template<class, nat_t, nat_t, nat_t...> friend class BasicNetwork;
+private:
+    Vector<inter_dim> output; // Layer output vector
+    Vector<inter_dim> sums;   // Layer sum of weighted inputs vector
+    Vector<inter_dim> error;  // Sum of weighted errors vector, from the output network
+    Vector<inter_dim> errors; // Neuron errors vector
+    Support<input_dim> support; // Layer input support, from the forward pass to the backward one
+    Workspace<inter_dim, output_dim...> next; // Output network workspace
+public:
+    /** Return the size of the structure.
+     * @return Size of the structure, in bytes
+    **/
+    static constexpr size_t size() {
+        return 4 * Vector<inter_dim>::size() + sizeof(support) + decltype(next)::size();
+    }
+    /** Get the network output vector, for the caller to compute into.
+     * @return Network output vector
+    **/
+    auto& result() {
+        return next.result();
+    }
+};
+template<nat_t input_dim, nat_t output_dim> class Workspace<input_dim, output_dim> final {
+    template<class, nat_t, nat_t, nat_t...> friend class BasicNetwork;
+private:
+    Vector<output_dim> output; // Layer output vector
+    Vector<output_dim> sums;   // Layer sum of weighted inputs vector
+    Vector<output_dim> errors; // Neuron errors vector
+    Vector<output_dim> outcome; // Network output vector, for the caller
+    Support<input_dim> support; // Layer input support, from the forward pass to the backward one
+public:
+    /** Return the size of the structure.
+     * @return Size of the structure, in bytes
+    **/
+    static constexpr size_t size() {
+        return 4 * Vector<output_dim>::size() + sizeof(support);
+    }
+    /** Get the network output vector, for the caller to compute into.
+     * @return Network output vector
+    **/
+    Vector<output_dim>& result() {
+        return outcome;
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Network of layers, right folded.
+ * @param Policy Activation policy
+ * @param ...    Input/output vector dimensions
+**/
+template<class Policy, nat_t input_dim, nat_t inter_dim, nat_t... output_dim> class BasicNetwork final {
+    static_assert(input_dim > 0, "Invalid input vector dimension");
+    static_assert(inter_dim > 0, "Invalid intermediate vector dimension");
+    template<class, nat_t, nat_t, nat_t...> friend class BasicNetwork;
+private:
+    constexpr static size_t unroll_size = 256; // Networks with at most this many parameters are computed by a single flattened kernel
+private:
+    typename Kind<typename Policy::head, input_dim, inter_dim>::type layer;  // Input layer
+    BasicNetwork<typename Policy::tail, inter_dim, output_dim...>      layers; // Output network
+public:
+    /** Workspace type of the network.
+    **/
+    using Space = Workspace<input_dim, inter_dim, output_dim...>;
+public:
+    /** Network constructor, for table-free activation functions.
+    **/
+    BasicNetwork(): layer(), layers() {}
+    /** Network constructor.
+     * @param trans Transfert function to use
+    **/
+    BasicNetwork(Transfert const& trans): layer(trans), layers(trans) {}
+public:
+    /** Randomize the network.
+     * @param rand Randomizer to use
+    **/
+    void randomize(Randomizer& rand) {
+        layer.randomize(rand);
+        layers.randomize(rand);
+    }
+    /** Randomize the network from the given position of a counter-based stream, the neurons being split between the workers.
+     * The result is the one of 'randomize' from there, whatever the number of workers.
+     * @param rand    Counter-based randomizer to use
+     * @param workers Workers to use
+     * @param first   Stream position of the first weight (optional)
+    **/
+    template<class Rand> void randomize(Rand const& rand, Workers& workers, uint64_t first = 0) {
+        layer.randomize(rand, first, workers);
+        layers.randomize(rand, workers, first + decltype(layer)::size() / sizeof(val_t));
+    }
+    /** Compute the output vector of the network.
+     * @param Out    Output stage
+     * @param input  Input vector
+     * @param output Output vector
+    **/
+    template<class Out = Stage::Quadratic, nat_t implicit_dim> void compute(Vector<input_dim> const& input, Vector<implicit_dim>& output) const {
+        timed_scope(Timing::name("network", { input_dim, inter_dim, output_dim... }));
+        if (size() <= unroll_size * sizeof(val_t)) { // Tiny network, intermediate vectors kept in registers
+            compute_flat<Out>(input, output);
+        } else {
+            compute_layers<Out>(input, output);
+        }
+    }
+    /** Compute the output vector of the network, the wide layers being split between the workers.
+     * @param Out     Output stage
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param workers Workers to use
+    **/
+    template<class Out = Stage::Quadratic, nat_t implicit_dim> void compute(Vector<input_dim> const& input, Vector<implicit_dim>& output, Workers& workers) const {
+        timed_scope(Timing::name("network", { input_dim, inter_dim, output_dim... }));
+        if (size() <= unroll_size * sizeof(val_t)) { // Tiny network
+            compute_flat<Out>(input, output);
+        } else {
+            compute_layers<Out>(input, output, workers);
+        }
+    }
+    /** Compute the output vector of the network, the intermediate vectors being kept in the given workspace.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param output    Output vector
+     * @param workspace Workspace to use, one per thread
+    **/
+    template<class Out = Stage::Quadratic, nat_t implicit_dim> void compute(Vector<input_dim> const& input, Vector<implicit_dim>& output, Space& workspace) const {
+        timed_scope(Timing::name("network", { input_dim, inter_dim, output_dim... }));
+        if (size() <= unroll_size * sizeof(val_t)) { // Tiny network, intermediate vectors kept in registers instead
+            compute_flat<Out>(input, output);
+        } else {
+            compute_layers<Out>(input, output, workspace);
+        }
+    }
+    /** Compute then reduce the error of the network.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param expected  Expected output vector
+     * @param error     Error vector (output)
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @param error_out <Reserved>
+    **/
+    template<class Out = Stage::Quadratic, nat_t implicit_dim, class Optim> void correct(Vector<input_dim> const& input, Vector<implicit_dim> const& expected, Vector<implicit_dim>& error, Optim& optim, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        if (size() <= unroll_size * sizeof(val_t)) { // Tiny network, intermediate vectors kept in registers
+            correct_flat<Out>(input, expected, error, optim, limit, error_out);
+        } else {
+            correct_layers<Out>(input, expected, error, optim, limit, error_out);
+        }
+    }
+    /** Compute then reduce the error of the network, the intermediate vectors being kept in the given workspace.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param expected  Expected output vector
+     * @param error     Error vector (output)
+     * @param workspace Workspace to use, one per thread
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @param error_out <Reserved>
+    **/
+    template<class Out = Stage::Quadratic, nat_t implicit_dim, class Optim> void correct(Vector<input_dim> const& input, Vector<implicit_dim> const& expected, Vector<implicit_dim>& error, Space& workspace, Optim& optim, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        if (size() <= unroll_size * sizeof(val_t)) { // Tiny network, intermediate vectors kept in registers instead
+            correct_flat<Out>(input, expected, error, optim, limit, error_out);
+        } else {
+            correct_layers<Out>(input, expected, error, workspace, optim, limit, error_out);
+        }
+    }
+    /** Compute then reduce the error of the network, plain gradient descent.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param expected  Expected output vector
+     * @param error     Error vector (output)
+     * @param eta       Correction factor
+     * @param limit     Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @param error_out <Reserved>
+    **/
+    template<class Out = Stage::Quadratic, nat_t implicit_dim> void correct(Vector<input_dim> const& input, Vector<implicit_dim> const& expected, Vector<implicit_dim>& error, val_t eta, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        Optimizer::Plain optim(eta);
+        correct<Out>(input, expected, error, optim, limit, error_out);
+    }
+private:
+    /** Compute the output vector of the network, layer by layer.
+     * @param Out    Output stage
+     * @param input  Input vector
+     * @param output Output vector
+    **/
+    template<class Out, nat_t implicit_dim> void compute_layers(Vector<input_dim> const& input, Vector<implicit_dim>& output) const {
+        Vector<inter_dim> local_output; // Local layer output vector
+        layer.compute(input, local_output);
+        layers.template compute_layers<Out>(local_output, output);
+    }
+    /** Compute the output vector of the network, layer by layer, the wide layers being split between the workers.
+     * @param Out     Output stage
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param workers Workers to use
+    **/
+    template<class Out, nat_t implicit_dim> void compute_layers(Vector<input_dim> const& input, Vector<implicit_dim>& output, Workers& workers) const {
+        Vector<inter_dim> local_output; // Local layer output vector
+        layer.compute(input, local_output, workers);
+        layers.template compute_layers<Out>(local_output, output, workers);
+    }
+    /** Compute the output vector of the network, layer by layer, in the given workspace.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param output    Output vector
+     * @param workspace Workspace to use
+    **/
+    template<class Out, nat_t implicit_dim> void compute_layers(Vector<input_dim> const& input, Vector<implicit_dim>& output, Space& workspace) const {
+        layer.compute(input, workspace.output, null, workspace.support);
+        layers.template compute_layers<Out>(workspace.output, output, workspace.next);
+    }
+    /** Compute the output vector of the network, every layer inlined in a single kernel.
+     * @param Out    Output stage
+     * @param input  Input vector
+     * @param output Output vector
+    **/
+    template<class Out, nat_t implicit_dim> flatten_calls void compute_flat(Vector<input_dim> const& input, Vector<implicit_dim>& output) const {
+        compute_layers<Out>(input, output);
+    }
+    /** Compute then reduce the error of the network, layer by layer.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param expected  Expected output vector
+     * @param error     Error vector (output)
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (<= 0 for none)
+     * @param error_out <Reserved>
+    **/
+    template<class Out, nat_t implicit_dim, class Optim> void correct_layers(Vector<input_dim> const& input, Vector<implicit_dim> const& expected, Vector<implicit_dim>& error, Optim& optim, val_t limit, Vector<input_dim>* error_out) {
+        Vector<inter_dim> local_output;
+        Vector<inter_dim> local_sums;
+        Support<input_dim> support; // Scanned once for both passes
+        layer.compute(input, local_output, &local_sums, support);
+        Vector<inter_dim> local_error;
+        layers.template correct_layers<Out>(local_output, expected, error, optim, limit, &local_error);
+        Vector<inter_dim> local_errors;
+        layer.correct(input, support, local_sums, local_error, local_errors, optim, limit / input_dim, error_out);
+    }
+    /** Compute then reduce the error of the network, layer by layer, in the given workspace.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param expected  Expected output vector
+     * @param error     Error vector (output)
+     * @param workspace Workspace to use
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (<= 0 for none)
+     * @param error_out <Reserved>
+    **/
+    template<class Out, nat_t implicit_dim, class Optim> void correct_layers(Vector<input_dim> const& input, Vector<implicit_dim> const& expected, Vector<implicit_dim>& error, Space& workspace, Optim& optim, val_t limit, Vector<input_dim>* error_out) {
+        layer.compute(input, workspace.output, &workspace.sums, workspace.support);
+        layers.template correct_layers<Out>(workspace.output, expected, error, workspace.next, optim, limit, &workspace.error);
+        layer.correct(input, workspace.support, workspace.sums, workspace.error, workspace.errors, optim, limit / input_dim, error_out);
+    }
+    /** Compute then reduce the error of the network, every layer inlined in a single kernel.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param expected  Expected output vector
+     * @param error     Error vector (output)
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (<= 0 for none)
+     * @param error_out <Reserved>
+    **/
+    template<class Out, nat_t implicit_dim, class Optim> flatten_calls void correct_flat(Vector<input_dim> const& input, Vector<implicit_dim> const& expected, Vector<implicit_dim>& error, Optim& optim, val_t limit, Vector<input_dim>* error_out) {
+        correct_layers<Out>(input, expected, error, optim, limit, error_out);
+    }
+public:
+    /** Return the size of the structure.
+     * @return Size of the structure, in bytes
+    **/
+    static constexpr size_t size() {
+        return decltype(layer)::size() + decltype(layers)::size();
+    }
+    /** Load layer data.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        layer.load(input);
+        layers.load(input);
+    }
+    /** Store vector data.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        layer.store(output);
+        layers.store(output);
+    }
+public:
+    /** Get the input layer.
+     * @return Input layer
+    **/
+    decltype(layer)& head() {
+        return layer;
+    }
+    /** Get the input layer, read-only.
+     * @return Input layer
+    **/
+    decltype(layer) const& head() const {
+        return layer;
+    }
+    /** Get the output network.
+     * @return Output network
+    **/
+    decltype(layers)& tail() {
+        return layers;
+    }
+    /** Get the output network, read-only.
+     * @return Output network
+    **/
+    decltype(layers) const& tail() const {
+        return layers;
+    }
+    /** Apply a function to each layer, from input to output.
+     * @param func Function to apply, called with each layer
+    **/
+    template<class Func> void each(Func&& func) {
+        func(layer);
+        layers.each(func);
+    }
+    /** Apply a function to each layer, from input to output, read-only.
+     * @param func Function to apply, called with each layer
+    **/
+    template<class Func> void each(Func&& func) const {
+        func(layer);
+        layers.each(func);
+    }
+public:
+    /** Read-only network whose parameters are laid out as by 'store', e.g. in a shared mapping, the activation functions being its own.
+    **/
+    class View final {
+    private:
+        typename Kind<typename Policy::head, input_dim, inter_dim>::type::View layer;  // Input layer
+        typename BasicNetwork<typename Policy::tail, inter_dim, output_dim...>::View layers; // Output network
+    public:
+        /** View constructor, attached to no parameter.
+         * @param trans Transfert function to use
+        **/
+        View(Transfert const& trans): layer(trans), layers(trans) {}
+    public:
+        /** Attach the view to its parameters.
+         * @param params Parameters of the network, laid out as by 'store'
+         * @return Past the parameters of the network
+        **/
+        val_t const* attach(val_t const* params) {
+            return layers.attach(layer.attach(params));
+        }
+        /** Compute the output vector of the network, layer by layer.
+         * @param Out    Output stage
+         * @param input  Input vector
+         * @param output Output vector
+        **/
+        template<class Out = Stage::Quadratic, nat_t implicit_dim> void compute(Vector<input_dim> const& input, Vector<implicit_dim>& output) const {
+            Vector<inter_dim> local_output; // Local layer output vector
+            layer.compute(input, local_output);
+            layers.template compute<Out>(local_output, output);
+        }
+    };
+public:
+    /** Print neuron weights to the given stream.
+     * @param ostr Output stream
+    **/
+    void print(::std::ostream& ostr) const {
+        layer.print(ostr);
+        ostr << ", ";
+        layers.print(ostr);
+    }
+};
+template<class Policy, nat_t input_dim, nat_t output_dim> class BasicNetwork<Policy, input_dim, output_dim> final {
+    static_assert(input_dim > 0, "Invalid input vector dimension");
+    static_assert(output_dim > 0, "Invalid output vector dimension");
+    template<class, nat_t, nat_t, nat_t...> friend class BasicNetwork;
+private:
+    typename Kind<typename Policy::last, input_dim, output_dim>::type layer; // Input/output layer
+public:
+    /** Workspace type of the network.
+    **/
+    using Space = Workspace<input_dim, output_dim>;
+public:
+    /** Network constructor, for table-free activation functions.
+    **/
+    BasicNetwork(): layer() {}
+    /** Network constructor.
+     * @param trans Transfert function to use
+    **/
+    BasicNetwork(Transfert const& trans): layer(trans) {}
+public:
+    /** Randomize the network.
+     * @param rand Randomizer to use
+    **/
+    void randomize(Randomizer& rand) {
+        layer.randomize(rand);
+    }
+    /** Randomize the network from the given position of a counter-based stream, the neurons being split between the workers.
+     * @param rand    Counter-based randomizer to use
+     * @param workers Workers to use
+     * @param first   Stream position of the first weight (optional)
+    **/
+    template<class Rand> void randomize(Rand const& rand, Workers& workers, uint64_t first = 0) {
+        layer.randomize(rand, first, workers);
+    }
+    /** Compute the output vector of the network.
+     * @param Out    Output stage
+     * @param input  Input vector
+     * @param output Output vector
+    **/
+    template<class Out = Stage::Quadratic> void compute(Vector<input_dim> const& input, Vector<output_dim>& output) const {
+        timed_scope(Timing::name("network", { input_dim, output_dim }));
+        compute_layers<Out>(input, output);
+    }
+    /** Compute the output vector of the network, the layer being split between the workers if wide.
+     * @param Out     Output stage
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param workers Workers to use
+    **/
+    template<class Out = Stage::Quadratic> void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Workers& workers) const {
+        timed_scope(Timing::name("network", { input_dim, output_dim }));
+        compute_layers<Out>(input, output, workers);
+    }
+    /** Compute the output vector of the network, the intermediate vectors being kept in the given workspace.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param output    Output vector
+     * @param workspace Workspace to use, one per thread
+    **/
+    template<class Out = Stage::Quadratic> void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Space& workspace) const {
+        timed_scope(Timing::name("network", { input_dim, output_dim }));
+        compute_layers<Out>(input, output, workspace);
+    }
+    /** Compute then reduce the error of the network.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param expected  Expected output vector
+     * @param error     Error vector (output)
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @param error_out <Reserved>
+    **/
+    template<class Out = Stage::Quadratic, class Optim> void correct(Vector<input_dim> const& input, Vector<output_dim> const& expected, Vector<output_dim>& error, Optim& optim, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        Vector<output_dim> local_output;
+        Vector<output_dim> local_sums;
+        Support<input_dim> support; // Scanned once for both passes
+        if (Out::transfert) {
+            layer.compute(input, local_output, &local_sums, support);
+        } else { // Output computed by the stage from the sums only
+            layer.sum(input, local_sums, support);
+        }
+        Out::activate(local_sums, local_output);
+        error = expected - local_output;
+        Vector<output_dim> local_errors;
+        layer.template correct<Out::transfert>(input, support, local_sums, error, local_errors, optim, limit / input_dim, error_out);
+    }
+    /** Compute then reduce the error of the network, the intermediate vectors being kept in the given workspace.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param expected  Expected output vector
+     * @param error     Error vector (output)
+     * @param workspace Workspace to use, one per thread
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @param error_out <Reserved>
+    **/
+    template<class Out = Stage::Quadratic, class Optim> void correct(Vector<input_dim> const& input, Vector<output_dim> const& expected, Vector<output_dim>& error, Space& workspace, Optim& optim, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        if (Out::transfert) {
+            layer.compute(input, workspace.output, &workspace.sums, workspace.support);
+        } else { // Output computed by the stage from the sums only
+            layer.sum(input, workspace.sums, workspace.support);
+        }
+        Out::activate(workspace.sums, workspace.output);
+        error = expected - workspace.output;
+        layer.template correct<Out::transfert>(input, workspace.support, workspace.sums, error, workspace.errors, optim, limit / input_dim, error_out);
+    }
+    /** Compute then reduce the error of the network, plain gradient descent.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param expected  Expected output vector
+     * @param error     Error vector (output)
+     * @param eta       Correction factor
+     * @param limit     Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @param error_out <Reserved>
+    **/
+    template<class Out = Stage::Quadratic> void correct(Vector<input_dim> const& input, Vector<output_dim> const& expected, Vector<output_dim>& error, val_t eta, val_t limit = 0, Vector<input_dim>* error_out = null) {
+        Optimizer::Plain optim(eta);
+        correct<Out>(input, expected, error, optim, limit, error_out);
+    }
+private:
+    /** Compute the output vector of the network, untimed, for the enclosing networks.
+     * @param Out    Output stage
+     * @param input  Input vector
+     * @param output Output vector
+    **/
+    template<class Out> void compute_layers(Vector<input_dim> const& input, Vector<output_dim>& output) const {
+        if (Out::transfert) {
+            layer.compute(input, output);
+        } else {
+            Vector<output_dim> sums;
+            layer.sum(input, sums);
+            Out::activate(sums, output);
+        }
+    }
+    /** Compute the output vector of the network, untimed, the layer being split between the workers if wide.
+     * @param Out     Output stage
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param workers Workers to use
+    **/
+    template<class Out> void compute_layers(Vector<input_dim> const& input, Vector<output_dim>& output, Workers& workers) const {
+        if (Out::transfert) {
+            layer.compute(input, output, workers);
+        } else {
+            Vector<output_dim> sums;
+            layer.sum(input, sums, workers);
+            Out::activate(sums, output);
+        }
+    }
+    /** Compute the output vector of the network, untimed, in the given workspace.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param output    Output vector
+     * @param workspace Workspace to use
+    **/
+    template<class Out> void compute_layers(Vector<input_dim> const& input, Vector<output_dim>& output, Space& workspace) const {
+        if (Out::transfert) {
+            layer.compute(input, output, null, workspace.support);
+        } else {
+            layer.sum(input, workspace.sums, workspace.support);
+            Out::activate(workspace.sums, output);
+        }
+    }
+    /** Compute then reduce the error of the network, for the enclosing networks.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param expected  Expected output vector
+     * @param error     Error vector (output)
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (<= 0 for none)
+     * @param error_out <Reserved>
+    **/
+    template<class Out, class Optim> void correct_layers(Vector<input_dim> const& input, Vector<output_dim> const& expected, Vector<output_dim>& error, Optim& optim, val_t limit, Vector<input_dim>* error_out) {
+        correct<Out>(input, expected, error, optim, limit, error_out);
+    }
+    /** Compute then reduce the error of the network, in the given workspace, for the enclosing networks.
+     * @param Out       Output stage
+     * @param input     Input vector
+     * @param expected  Expected output vector
+     * @param error     Error vector (output)
+     * @param workspace Workspace to use
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (<= 0 for none)
+     * @param error_out <Reserved>
+    **/
+    template<class Out, class Optim> void correct_layers(Vector<input_dim> const& input, Vector<output_dim> const& expected, Vector<output_dim>& error, Space& workspace, Optim& optim, val_t limit, Vector<input_dim>* error_out) {
+        correct<Out>(input, expected, error, workspace, optim, limit, error_out);
+    }
+public:
+    /** Return the size of the structure.
+     * @return Size of the structure, in bytes
+    **/
+    static constexpr size_t size() {
+        return decltype(layer)::size();
+    }
+    /** Load layer data.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        layer.load(input);
+    }
+    /** Store vector data.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        layer.store(output);
+    }
+public:
+    /** Get the input/output layer.
+     * @return Input/output layer
+    **/
+    decltype(layer)& head() {
+        return layer;
+    }
+    /** Get the input/output layer, read-only.
+     * @return Input/output layer
+    **/
+    decltype(layer) const& head() const {
+        return layer;
+    }
+    /** Apply a function to the layer.
+     * @param func Function to apply, called with the layer
+    **/
+    template<class Func> void each(Func&& func) {
+        func(layer);
+    }
+    /** Apply a function to the layer, read-only.
+     * @param func Function to apply, called with the layer
+    **/
+    template<class Func> void each(Func&& func) const {
+        func(layer);
+    }
+public:
+    /** Read-only network whose parameters are laid out as by 'store', e.g. in a shared mapping, the activation function being its own.
+    **/
+    class View final {
+    private:
+        typename Kind<typename Policy::last, input_dim, output_dim>::type::View layer; // Input/output layer
+    public:
+        /** View constructor, attached to no parameter.
+         * @param trans Transfert function to use
+        **/
+        View(Transfert const& trans): layer(trans) {}
+    public:
+        /** Attach the view to its parameters.
+         * @param params Parameters of the network, laid out as by 'store'
+         * @return Past the parameters of the network
+        **/
+        val_t const* attach(val_t const* params) {
+            return layer.attach(params);
+        }
+        /** Compute the output vector of the network.
+         * @param Out    Output stage
+         * @param input  Input vector
+         * @param output Output vector
+        **/
+        template<class Out = Stage::Quadratic> void compute(Vector<input_dim> const& input, Vector<output_dim>& output) const {
+            if (Out::transfert) {
+                layer.compute(input, output);
+            } else {
+                Vector<output_dim> sums;
+                layer.sum(input, sums);
+                Out::activate(sums, output);
+            }
+        }
+    };
+public:
+    /** Print neuron weights to the given stream.
+     * @param ostr Output stream
+    **/
+    void print(::std::ostream& ostr) const {
+        layer.print(ostr);
+    }
+};
+
+/** Network of layers, through the transfert function at every layer.
+ * @param ... Input/output vector dimensions
+**/
+template<nat_t... dims> using Network = BasicNetwork<Activation::Uniform<Activation::Table>, dims...>;
+
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Neural Network ▔
+// ▁ Replication ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+
+/** Read-only replicas of a network, one per NUMA node, each with its own workers pinned to the node.
+ * Each replica is allocated and copied by a thread running on its node, so that its pages are node-local.
+ * The transfert function table is shared by every replica.
+ * @param Net   Network type
+ * @param Alloc Allocation policy of the replicas, binding pages to the node of the allocating thread
+**/
+template<class Net, class Alloc = Allocator::Numa<>> class Replicas final {
+private:
+    /** Replica of a node.
+    **/
+    class Replica final {
+    public:
+        Net network; // Node-local network
+        Workers workers; // Workers pinned to the node
+    public:
+        /** Copy constructor.
+         * @param master  Network to copy
+         * @param workers CPU of each worker
+        **/
+        Replica(Net const& master, ::std::vector<nat_t> const& workers): network(master), workers(workers) {}
+    };
+private:
+    Topology topology; // Machine topology
+    ::std::vector<::std::unique_ptr<Allocated<Replica, Alloc>>> replicas; // Replica of each node, in node-local memory
+private:
+    /** Run a function on a thread pinned to a node, and wait for it.
+     * @param node Node to run on
+     * @param func Function to run
+    **/
+    template<class Func> void on(nat_t node, Func&& func) {
+        ::std::thread thread([this, node, &func]() {
+            Topology::pin(topology.cpus(node));
+            func();
+        });
+        thread.join();
+    }
+public:
+    /** Replicate a network on every node.
+     * @param master   Network to replicate
+     * @param count    Number of worker threads per node (optional, at most the number of CPUs of the node minus one)
+     * @param topology Machine topology (optional)
+    **/
+    Replicas(Net const& master, nat_t count = 0, Topology topology = Topology()): topology(::std::move(topology)), replicas() {
+        nat_t nodes = this->topology.size();
+        replicas.resize(nodes);
+        for (nat_t node = 0; node < nodes; node++) {
+            ::std::vector<nat_t> const& cpus = this->topology.cpus(node);
+            ::std::vector<nat_t> workers(cpus.begin() + 1, cpus.begin() + ::std::min<nat_t>(count + 1, cpus.size())); // First CPU left to the caller
+            on(node, [&]() {
+                replicas[node].reset(new Allocated<Replica, Alloc>(master, workers));
+            });
+        }
+    }
+    /** Copy constructor (deleted).
+    **/
+    Replicas(Replicas const&) = delete;
+public:
+    /** Copy the weights of the given network into every replica, replicas must not be in use.
+     * @param master Network to copy, of the same shape
+    **/
+    void update(Net const& master) {
+        for (nat_t node = 0; node < replicas.size(); node++) {
+            on(node, [&]() {
+                (*replicas[node])->network = master;
+            });
+        }
+    }
+    /** Pin the calling thread to the first CPU of a node, left free of workers, so that its scratch vectors are node-local.
+     * @param node Node index
+    **/
+    void enter(nat_t node) const {
+        Topology::pin({ topology.cpus(node).front() });
+    }
+    /** Compute the output vector with the replica of the node the calling thread runs on.
+     * The workers of a node must not be used by several threads at once.
+     * @param Out    Output stage
+     * @param input  Input vector
+     * @param output Output vector
+    **/
+    template<class Out = Stage::Quadratic, nat_t input_dim, nat_t output_dim> void compute(Vector<input_dim> const& input, Vector<output_dim>& output) const {
+        Replica& replica = **replicas[topology.local()];
+        replica.network.template compute<Out>(input, output, replica.workers);
+    }
+public:
+    /** Return the number of replicas.
+     * @return Number of replicas, one per node
+    **/
+    nat_t size() const {
+        return static_cast<nat_t>(replicas.size());
+    }
+    /** Get the replica of a node.
+     * @param node Node index
+     * @return Node-local network
+    **/
+    Net const& get(nat_t node) const {
+        return (*replicas[node])->network;
+    }
+    /** Get the workers of a node.
+     * @param node Node index
+     * @return Workers pinned to the node
+    **/
+    Workers& workers(nat_t node) const {
+        return (*replicas[node])->workers;
+    }
+    /** Get the machine topology.
+     * @return Machine topology
+    **/
+    Topology const& nodes() const {
+        return topology;
+    }
+};
+
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Replication ▔
+// ▁ Cascade ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+
+/** Confidence-gated cascade of two networks of the same input and output dimensions.
+ * The cheap network answers first, the full network being only run when the gap between the two largest outputs of
+ * the cheap network is below a threshold, i.e. when the cheap network is not confident enough in its answer.
+ * @param Cheap Cheap network type
+ * @param Full  Full network type
+**/
+template<class Cheap, class Full> class Cascade final {
+private:
+    Cheap const& cheap; // Network run first
+    Full  const& full;  // Network run on escalation
+    val_t threshold;    // Gap under which a request escalates
+    mutable ::std::atomic<uint_fast64_t> requests;  // Requests served
+    mutable ::std::atomic<uint_fast64_t> escalated; // Requests escalated to the full network
+public:
+    /** Gap between the two largest outputs, the largest one being the answer of the network.
+     * @param output Output vector, of at least 2 dimensions
+     * @return Non-negative gap
+    **/
+    template<nat_t dim> static val_t gap(Vector<dim> const& output) {
+        static_assert(dim >= 2, "Output vector must have at least 2 dimensions");
+        val_t first  = output.get(0);
+        val_t second = output.get(1);
+        if (second > first)
+            ::std::swap(first, second);
+        for (nat_t i = 2; i < dim; i++) {
+            val_t val = output.get(i);
+            if (val > first) {
+                second = first;
+                first  = val;
+            } else if (val > second) {
+                second = val;
+            }
+        }
+        return first - second;
+    }
+public:
+    /** Build a cascade.
+     * @param cheap     Network run first, must outlive the cascade
+     * @param full      Network run on escalation, must outlive the cascade
+     * @param threshold Gap under which a request escalates (optional, 0 for never)
+    **/
+    Cascade(Cheap const& cheap, Full const& full, val_t threshold = 0): cheap(cheap), full(full), threshold(threshold), requests(0), escalated(0) {}
+    /** Copy constructor (deleted).
+    **/
+    Cascade(Cascade const&) = delete;
+public:
+    /** Compute the output vector, escalating to the full network if the cheap network is not confident enough.
+     * @param Out    Output stage
+     * @param input  Input vector
+     * @param output Output vector
+    **/
+    template<class Out = Stage::Quadratic, nat_t input_dim, nat_t output_dim> void compute(Vector<input_dim> const& input, Vector<output_dim>& output) const {
+        requests.fetch_add(1, ::std::memory_order_relaxed);
+        cheap.template compute<Out>(input, output);
+        if (likely(gap(output) >= threshold))
+            return;
+        escalated.fetch_add(1, ::std::memory_order_relaxed);
+        full.template compute<Out>(input, output);
+    }
+public:
+    /** Get the cheap network.
+     * @return Network run first
+    **/
+    Cheap const& first() const {
+        return cheap;
+    }
+    /** Get the full network.
+     * @return Network run on escalation
+    **/
+    Full const& second() const {
+        return full;
+    }
+    /** Get the escalation threshold.
+     * @return Gap under which a request escalates
+    **/
+    val_t get() const {
+        return threshold;
+    }
+    /** Set the escalation threshold, the cascade must not be in use.
+     * @param value Gap under which a request escalates
+    **/
+    void set(val_t value) {
+        threshold = value;
+    }
+    /** Get the escalation rate since the last reset.
+     * @return Ratio of requests escalated to the full network (0 if none served)
+    **/
+    double rate() const {
+        uint_fast64_t total = requests.load(::std::memory_order_relaxed);
+        return total > 0 ? static_cast<double>(escalated.load(::std::memory_order_relaxed)) / total : 0;
+    }
+    /** Reset the request counters.
+    **/
+    void reset() {
+        requests.store(0, ::std::memory_order_relaxed);
+        escalated.store(0, ::std::memory_order_relaxed);
+    }
+};
+
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Cascade ▔
+// ▁ Pruning ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+namespace Pruning {
+
+/** Number of blocks of consecutive weights of a neuron, the last one possibly partial.
+ * @param block Block size, in weights
+ * @param dim   Input dimension of the neuron
+ * @return Number of blocks
+**/
+template<nat_t block, nat_t dim> constexpr nat_t blocks(Neuron<dim> const&) {
+    return (dim + block - 1) / block;
+}
+
+/** L1 norm of a block of weights of a neuron.
+ * @param block  Block size, in weights
+ * @param neuron Neuron
+ * @param id     Block id
+ * @return L1 norm
+**/
+template<nat_t block, nat_t dim> val_t norm(Neuron<dim> const& neuron, nat_t id) {
+    val_t const* weight = neuron.weight.data();
+    val_t sum = 0;
+    for (nat_t i = id * block; i < (id + 1) * block && i < dim; i++)
+        sum += ::std::fabs(weight[i]);
+    return sum;
+}
+
+/** Zero a block of weights of a neuron.
+ * @param block  Block size, in weights
+ * @param neuron Neuron
+ * @param id     Block id
+**/
+template<nat_t block, nat_t dim> void clear(Neuron<dim>& neuron, nat_t id) {
+    val_t* weight = neuron.weight.data();
+    for (nat_t i = id * block; i < (id + 1) * block && i < dim; i++)
+        weight[i] = 0;
+}
+
+/** Keep the blocks whose norms are above a threshold, or equal to it while ties remain, zero the others.
+ * @param block     Block size, in weights
+ * @param neuron    Neuron
+ * @param threshold Minimal kept norm
+ * @param ties      Number of blocks with a norm equal to the threshold still to keep (updated)
+ * @return Number of blocks kept
+**/
+template<nat_t block, nat_t dim> size_t keep(Neuron<dim>& neuron, val_t threshold, size_t& ties) {
+    size_t kept = 0;
+    for (nat_t i = 0; i < blocks<block>(neuron); i++) {
+        val_t value = norm<block>(neuron, i);
+        if (value > 0 && (value > threshold || (value == threshold && ties > 0 && ties--))) {
+            kept++;
+        } else {
+            clear<block>(neuron, i);
+        }
+    }
+    return kept;
+}
+
+/** Get the threshold keeping the given amount of the largest norms.
+ * @param norms Norms (reordered)
+ * @param count Number of norms to keep
+ * @param ties  Number of norms equal to the threshold to keep (output)
+ * @return Threshold
+**/
+inline val_t threshold(::std::vector<val_t>& norms, size_t count, size_t& ties) {
+    ties = count;
+    if (count == 0)
+        return ::std::numeric_limits<val_t>::infinity();
+    if (count >= norms.size())
+        return 0;
+    auto nth = norms.begin() + (norms.size() - count);
+    ::std::nth_element(norms.begin(), nth, norms.end());
+    val_t limit = *nth;
+    for (auto it = nth; it != norms.end(); it++) { // Saturated weights often share the same norm
+        if (*it > limit)
+            ties--;
+    }
+    return limit;
+}
+
+/** Prune a network by magnitude, by blocks of consecutive weights of each neuron (biases are kept).
+ * @param block      Block size, in weights (1 for single weights)
+ * @param network    Network to prune
+ * @param density    Fraction of the blocks to keep, in [0, 1]
+ * @param per_neuron Keep this fraction of the blocks of each neuron, instead of the whole network (optional)
+ * @return Number of blocks kept
+**/
+template<nat_t block = 1, class Net> size_t prune(Net& network, val_t density, bool per_neuron = false) {
+    static_assert(block > 0, "Invalid block size");
+    ::std::vector<val_t> norms;
+    size_t kept = 0;
+    if (per_neuron) {
+        network.each([&](auto& layer) {
+            layer.each([&](auto& neuron) {
+                norms.clear();
+                for (nat_t i = 0; i < blocks<block>(neuron); i++)
+                    norms.push_back(norm<block>(neuron, i));
+                size_t ties;
+                val_t limit = threshold(norms, static_cast<size_t>(::std::round(density * norms.size())), ties);
+                kept += keep<block>(neuron, limit, ties);
+            });
+        });
+    } else {
+        network.each([&](auto const& layer) {
+            layer.each([&](auto const& neuron) {
+                for (nat_t i = 0; i < blocks<block>(neuron); i++)
+                    norms.push_back(norm<block>(neuron, i));
+            });
+        });
+        size_t ties;
+        val_t limit = threshold(norms, static_cast<size_t>(::std::round(density * norms.size())), ties);
+        network.each([&](auto& layer) {
+            layer.each([&](auto& neuron) {
+                kept += keep<block>(neuron, limit, ties);
+            });
+        });
+    }
+    return kept;
+}
+
+/** Get the fraction of nonzero weights of a network (biases excluded).
+ * @param network Network to scan
+ * @return Fraction of nonzero weights
+**/
+template<class Net> val_t density(Net const& network) {
+    size_t total = 0;
+    size_t count = 0;
+    network.each([&](auto const& layer) {
+        layer.each([&](auto const& neuron) {
+            val_t const* weight = neuron.weight.data();
+            for (nat_t i = 0; i < neuron.weight.length(); i++)
+                count += (weight[i] != 0 ? 1 : 0);
+            total += neuron.weight.length();
+        });
+    });
+    return static_cast<val_t>(count) / static_cast<val_t>(total);
+}
+
+}
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Layer of neurons with compressed weights.
+ * Only the blocks of consecutive weights holding a nonzero weight are stored, row by row (CSR for single weights).
+ * Serialized form, per neuron: bias, number of blocks, then for each block its first input and its weights.
+ * @param input_dim  Input vector dimension
+ * @param output_dim Output vector dimension
+ * @param Act        Activation function
+ * @param block      Block size, in weights
+**/
+template<nat_t input_dim, nat_t output_dim, class Act = Activation::Table, nat_t block = 4> class SparseLayer final {
+    static_assert(input_dim > 0, "Invalid input vector dimension");
+    static_assert(output_dim > 0, "Invalid output vector dimension");
+    static_assert(block > 0, "Invalid block size");
+private:
+    constexpr static nat_t padded_dim = (input_dim + block - 1) / block * block; // Input dimension, whole blocks
+    constexpr static nat_t lanes      = 4; // Blocks accumulated independently, not bound by the add latency
+private:
+    Act act; // Activation function to use
+    val_t bias[output_dim];      // Neuron biases
+    nat_t rows[output_dim + 1];  // First block of each neuron, then the number of blocks
+    ::std::vector<nat_t> index;  // First input of each block
+    ::std::vector<val_t> value;  // Weights of each block
+private:
+    /** Scalar product of blocks of weights with the input.
+     * @param values  Weights of the blocks
+     * @param indices First input of each block
+     * @param x       Input, whole blocks
+     * @param begin   First block
+     * @param end     Past the last block
+     * @return Scalar product
+    **/
+    static val_t dot(val_t const* values, nat_t const* indices, val_t const* x, nat_t begin, nat_t end) {
+        val_t part[lanes * block] = {}; // Partial sums, flat so that whole blocks are vectorized
+        nat_t k = begin;
+        for (; k + lanes <= end; k += lanes) {
+            for (nat_t l = 0; l < lanes; l++) {
+                val_t const* w = values + (k + l) * block;
+                val_t const* v = x + indices[k + l];
+                for (nat_t j = 0; j < block; j++)
+                    part[l * block + j] += w[j] * v[j];
+            }
+        }
+        for (; k < end; k++) { // Remaining blocks
+            val_t const* w = values + k * block;
+            val_t const* v = x + indices[k];
+            for (nat_t j = 0; j < block; j++)
+                part[j] += w[j] * v[j];
+        }
+        val_t sum = 0;
+        for (nat_t j = 0; j < lanes * block; j++)
+            sum += part[j];
+        return sum;
+    }
+public:
+    /** Empty layer constructor, for table-free activation functions.
+    **/
+    SparseLayer(): act() {
+        ::std::fill(rows, rows + output_dim + 1, nat_t(0));
+    }
+    /** Empty layer constructor.
+     * @param trans Transfert function to use
+    **/
+    SparseLayer(Transfert const& trans): act(trans) {
+        ::std::fill(rows, rows + output_dim + 1, nat_t(0));
+    }
+    /** Compress a layer.
+     * @param layer Layer to compress
+    **/
+    SparseLayer(Layer<input_dim, output_dim, Act> const& layer): act(layer.activation()) {
+        rows[0] = 0;
+        for (nat_t i = 0; i < output_dim; i++) {
+            Neuron<input_dim> const& neuron = layer.neuron(i);
+            val_t const* weight = neuron.weight.data();
+            for (nat_t j = 0; j < input_dim; j += block) {
+                bool live = false;
+                for (nat_t k = j; k < j + block && k < input_dim; k++)
+                    live = live || weight[k] != 0;
+                if (!live)
+                    continue;
+                index.push_back(j);
+                for (nat_t k = j; k < j + block; k++)
+                    value.push_back(k < input_dim ? weight[k] : 0);
+            }
+            bias[i] = neuron.bias;
+            rows[i + 1] = static_cast<nat_t>(index.size());
+        }
+    }
+public:
+    /** Compute the output vector of the layer.
+     * @param input   Input vector
+     * @param output  Output vector
+     * @param out_sum Sum of weighted inputs vector (output, optional)
+    **/
+    void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum = null) const {
+        val_t padded[padded_dim]; // Input with whole blocks
+        val_t const* x = input.data();
+        if (padded_dim != input_dim) {
+            ::std::copy(x, x + input_dim, padded);
+            ::std::fill(padded + input_dim, padded + padded_dim, val_t(0));
+            x = padded;
+        }
+        for (nat_t i = 0; i < output_dim; i++) {
+            val_t sum = bias[i] + dot(value.data(), index.data(), x, rows[i], rows[i + 1]);
+            output.set(i, act(sum));
+            if (out_sum)
+                out_sum->set(i, sum);
+        }
+    }
+    /** Compute the sums of weighted inputs of the layer only, for an output stage replacing the activation function.
+     * @param input Input vector
+     * @param sums  Sum of weighted inputs vector (output)
+    **/
+    void sum(Vector<input_dim> const& input, Vector<output_dim>& sums) const {
+        val_t padded[padded_dim]; // Input with whole blocks
+        val_t const* x = input.data();
+        if (padded_dim != input_dim) {
+            ::std::copy(x, x + input_dim, padded);
+            ::std::fill(padded + input_dim, padded + padded_dim, val_t(0));
+            x = padded;
+        }
+        for (nat_t i = 0; i < output_dim; i++)
+            sums.set(i, bias[i] + dot(value.data(), index.data(), x, rows[i], rows[i + 1]));
+    }
+public:
+    /** Return the number of stored blocks.
+     * @return Number of blocks
+    **/
+    size_t size() const {
+        return index.size();
+    }
+    /** Load layer data, the block counts and indices being checked against the layer dimensions.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        index.clear();
+        value.clear();
+        rows[0] = 0;
+        for (nat_t i = 0; i < output_dim; i++) {
+            bias[i] = input.load();
+            nat_t count = input.load_index();
+            if (unlikely(count > padded_dim / block))
+                throw ::std::runtime_error("Invalid sparse layer data: too many blocks for the input dimension");
+            for (nat_t k = 0; k < count; k++) {
+                nat_t first = input.load_index();
+                if (unlikely(first >= input_dim || first % block != 0))
+                    throw ::std::runtime_error("Invalid sparse layer data: block outside of the input vector");
+                index.push_back(first);
+                for (nat_t j = 0; j < block; j++)
+                    value.push_back(input.load());
+            }
+            rows[i + 1] = static_cast<nat_t>(index.size());
+        }
+    }
+    /** Store layer data.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        for (nat_t i = 0; i < output_dim; i++) {
+            output.store(bias[i]);
+            output.store_index(rows[i + 1] - rows[i]);
+            for (nat_t k = rows[i]; k < rows[i + 1]; k++) {
+                output.store_index(index[k]);
+                for (nat_t j = 0; j < block; j++)
+                    output.store(value[k * block + j]);
+            }
+        }
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Network of compressed layers, right folded, inference only.
+ * @param Policy Activation policy
+ * @param block  Block size, in weights
+ * @param ...    Input/output vector dimensions
+**/
+template<class Policy, nat_t block, nat_t input_dim, nat_t inter_dim, nat_t... output_dim> class SparseNetwork final {
+private:
+    SparseLayer<input_dim, inter_dim, typename Policy::head, block>        layer;  // Input layer
+    SparseNetwork<typename Policy::tail, block, inter_dim, output_dim...> layers; // Output network
+public:
+    /** Empty network constructor, for table-free activation functions.
+    **/
+    SparseNetwork(): layer(), layers() {}
+    /** Empty network constructor.
+     * @param trans Transfert function to use
+    **/
+    SparseNetwork(Transfert const& trans): layer(trans), layers(trans) {}
+    /** Compress a network.
+     * @param network Network to compress
+    **/
+    SparseNetwork(BasicNetwork<Policy, input_dim, inter_dim, output_dim...> const& network): layer(network.head()), layers(network.tail()) {}
+public:
+    /** Compute the output vector of the network.
+     * @param Out    Output stage
+     * @param input  Input vector
+     * @param output Output vector
+    **/
+    template<class Out = Stage::Quadratic, nat_t implicit_dim> void compute(Vector<input_dim> const& input, Vector<implicit_dim>& output) const {
+        Vector<inter_dim> local_output; // Local layer output vector
+        layer.compute(input, local_output);
+        layers.template compute<Out>(local_output, output);
+    }
+public:
+    /** Return the number of stored blocks.
+     * @return Number of blocks
+    **/
+    size_t size() const {
+        return layer.size() + layers.size();
+    }
+    /** Load network data.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        layer.load(input);
+        layers.load(input);
+    }
+    /** Store network data.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        layer.store(output);
+        layers.store(output);
+    }
+};
+template<class Policy, nat_t block, nat_t input_dim, nat_t output_dim> class SparseNetwork<Policy, block, input_dim, output_dim> final {
+private:
+    SparseLayer<input_dim, output_dim, typename Policy::last, block> layer; // Input/output layer
+public:
+    /** Empty network constructor, for table-free activation functions.
+    **/
+    SparseNetwork(): layer() {}
+    /** Empty network constructor.
+     * @param trans Transfert function to use
+    **/
+    SparseNetwork(Transfert const& trans): layer(trans) {}
+    /** Compress a network.
+     * @param network Network to compress
+    **/
+    SparseNetwork(BasicNetwork<Policy, input_dim, output_dim> const& network): layer(network.head()) {}
+public:
+    /** Compute the output vector of the network.
+     * @param Out    Output stage
+     * @param input  Input vector
+     * @param output Output vector
+    **/
+    template<class Out = Stage::Quadratic> void compute(Vector<input_dim> const& input, Vector<output_dim>& output) const {
+        if (Out::transfert) {
+            layer.compute(input, output);
+        } else {
+            Vector<output_dim> sums;
+            layer.sum(input, sums);
+            Out::activate(sums, output);
+        }
+    }
+public:
+    /** Return the number of stored blocks.
+     * @return Number of blocks
+    **/
+    size_t size() const {
+        return layer.size();
+    }
+    /** Load network data.
+     * @param input Serialized input
+    **/
+    void load(Serializer::Input& input) {
+        layer.load(input);
+    }
+    /** Store network data.
+     * @param output Serialized output
+    **/
+    void store(Serializer::Output& output) const {
+        layer.store(output);
+    }
+};
+
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Pruning ▔
+// ▁ Pipeline ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+namespace Pipelined {
+
+/** Bounded single-producer single-consumer lock-free queue.
+ * @param Item     Item type
+ * @param capacity Maximal number of items
+**/
+template<class Item, nat_t capacity> class Channel final {
+private:
+    alignas(Allocator::cache_line) ::std::atomic<nat_t> head; // Next item to pop, written by the consumer
+    alignas(Allocator::cache_line) ::std::atomic<nat_t> tail; // Next item to push, written by the producer
+    Item items[capacity]; // Items
+public:
+    /** Empty queue constructor.
+    **/
+    Channel(): head(0), tail(0) {}
+public:
+    /** Push an item, producer side.
+     * @param item Item to push
+     * @return True on success, false if full
+    **/
+    bool push(Item const& item) {
+        nat_t pos = tail.load(::std::memory_order_relaxed);
+        if (pos - head.load(::std::memory_order_acquire) == capacity)
+            return false;
+        items[pos % capacity] = item;
+        tail.store(pos + 1, ::std::memory_order_release);
+        return true;
+    }
+    /** Pop an item, consumer side.
+     * @param item Popped item (output)
+     * @return True on success, false if empty
+    **/
+    bool pop(Item& item) {
+        nat_t pos = head.load(::std::memory_order_relaxed);
+        if (pos == tail.load(::std::memory_order_acquire))
+            return false;
+        item = items[pos % capacity];
+        head.store(pos + 1, ::std::memory_order_release);
+        return true;
+    }
+    /** Tell whether the queue is empty, consumer side.
+     * @return True if empty, false otherwise
+    **/
+    bool empty() const {
+        return head.load(::std::memory_order_relaxed) == tail.load(::std::memory_order_acquire);
+    }
+};
+
+/** Vector of a sample in flight.
+ * @param dim Vector dimension
+**/
+template<nat_t dim> class Message final {
+public:
+    nat_t id; // Sample id
+    Vector<dim> data; // Sample vector
+};
+
+/** State shared by every stage of a pipeline.
+ * @param Optim      Optimizer type
+ * @param output_dim Output vector dimension
+ * @param slots      Maximal number of samples in flight
+**/
+template<class Optim, nat_t output_dim, nat_t slots> class Context final {
+public:
+    constexpr static nat_t depth = slots; // Maximal number of samples in flight
+    constexpr static nat_t spin_count = 1 << 10; // Polls of an empty queue before yielding (or parking, for a station)
+public:
+    Optim& optim; // Optimizer to use
+    val_t  limit; // Weight absolute value limit times input synapses (<= 0 for none)
+    Vector<output_dim> const* expected[depth]; // Expected output vector of each sample in flight
+    Vector<output_dim> const* margin[depth];   // Tolerated margin vector of each sample in flight
+    ::std::atomic<bool>  busy[depth]; // Whether each slot holds a sample in flight
+    ::std::atomic<nat_t> corrected;   // Number of corrected samples
+    ::std::atomic<bool>  stop;        // Whether the stations must stop
+private:
+    ::std::atomic<nat_t> sleepers; // Number of parked stations
+    ::std::mutex lock; // Lock of the parked stations
+    ::std::condition_variable cond; // Wakes up the parked stations
+public:
+    /** Constructor.
+     * @param optim Optimizer to use
+     * @param limit Weight absolute value limit times input synapses (<= 0 for none)
+    **/
+    Context(Optim& optim, val_t limit): optim(optim), limit(limit), corrected(0), stop(false), sleepers(0), lock(), cond() {
+        for (nat_t i = 0; i < depth; i++)
+            busy[i].store(false, ::std::memory_order_relaxed);
+    }
+public:
+    /** Push an item, waiting for room, then wake up the parked stations if any.
+     * @param channel Channel to push to
+     * @param item    Item to push
+    **/
+    template<class Channel, class Item> void send(Channel& channel, Item const& item) {
+        for (nat_t i = 0; !channel.push(item); i++) {
+            if (i >= spin_count)
+                ::std::this_thread::yield();
+        }
+        wake();
+    }
+    /** Tell the stations to stop, waking them up.
+    **/
+    void halt() {
+        stop.store(true, ::std::memory_order_release);
+        wake();
+    }
+    /** Park the calling station until the next 'send' or 'halt', unless it already has something to do.
+     * @param ready Function telling whether the station has something to do
+    **/
+    template<class Ready> void park(Ready&& ready) {
+        ::std::unique_lock<decltype(lock)> guard(lock);
+        sleepers.fetch_add(1, ::std::memory_order_relaxed);
+        ::std::atomic_thread_fence(::std::memory_order_seq_cst); // Counted before checking, pairs with the one of 'wake'
+        if (!ready() && !stop.load(::std::memory_order_acquire))
+            cond.wait(guard); // Spurious wake-ups only cost another round of polling
+        sleepers.fetch_sub(1, ::std::memory_order_relaxed);
+    }
+    /** Wake up the parked stations, if any.
+    **/
+    void wake() {
+        ::std::atomic_thread_fence(::std::memory_order_seq_cst); // Published before counting, pairs with the one of 'park'
+        if (likely(sleepers.load(::std::memory_order_relaxed) == 0))
+            return;
+        ::std::lock_guard<decltype(lock)> guard(lock); // Not between the check and the wait of a parking station
+        cond.notify_all();
+    }
+    /** Mark a sample as done.
+     * @param id Sample id
+    **/
+    void complete(nat_t id) {
+        busy[id % depth].store(false, ::std::memory_order_release);
+    }
+};
+
+/** Stations of a pipeline, one thread per layer, right folded like the network.
+ * Each station keeps the inputs and weighted sums of the samples in flight for their backward pass.
+ * @param Out    Output stage
+ * @param Ctx    Shared context type
+ * @param Policy Activation policy
+ * @param ...    Input/output vector dimensions
+**/
+template<class Out, class Ctx, class Policy, nat_t... dims> class Station;
+template<class Out, class Ctx, class Policy, nat_t input_dim, nat_t inter_dim, nat_t... output_dim> class Station<Out, Ctx, Policy, input_dim, inter_dim, output_dim...> final {
+private:
+    constexpr static nat_t depth = Ctx::depth;
+private:
+    typename Kind<typename Policy::head, input_dim, inter_dim>::type& layer; // Owned layer
+    Ctx& context; // Shared context
+    Channel<Message<input_dim>, depth>* upward; // Backward queue of the previous station (null for the first station)
+    Channel<Message<input_dim>, depth> forward; // Inputs from the previous station
+    Channel<Message<inter_dim>, depth> backward; // Errors from the next station
+    Vector<input_dim> inputs[depth]; // Inputs of the samples in flight
+    Vector<inter_dim> sums[depth];   // Weighted sums of the samples in flight
+    Station<Out, Ctx, typename Policy::tail, inter_dim, output_dim...> next; // Next stations
+    ::std::thread thread; // Station thread
+private:
+    /** Station thread entry point, backward passes first so that the samples in flight complete early.
+    **/
+    void run() {
+        Message<input_dim> input;
+        Message<inter_dim> output;
+        Message<inter_dim> error;
+        Message<input_dim> error_out;
+        nat_t idle = 0;
+        while (!context.stop.load(::std::memory_order_acquire)) {
+            if (backward.pop(error)) {
+                nat_t slot = error.id % depth;
+                layer.correct(inputs[slot], sums[slot], error.data, context.optim, context.limit / input_dim, upward ? &error_out.data : null);
+                if (upward) {
+                    error_out.id = error.id;
+                    context.send(*upward, error_out);
+                } else {
+                    context.complete(error.id);
+                }
+                idle = 0;
+            } else if (forward.pop(input)) {
+                nat_t slot = input.id % depth;
+                inputs[slot] = input.data;
+                layer.compute(input.data, output.data, &sums[slot]);
+                output.id = input.id;
+                context.send(next.inbox(), output);
+                idle = 0;
+            } else if (++idle >= Ctx::spin_count) {
+                context.park([this]() { return !backward.empty() || !forward.empty(); });
+                idle = 0;
+            }
+        }
+    }
+public:
+    /** Start the station and the next ones.
+     * @param network Network whose input layer is owned by this station
+     * @param context Shared context
+     * @param upward  Backward queue of the previous station (null for the first station)
+    **/
+    Station(BasicNetwork<Policy, input_dim, inter_dim, output_dim...>& network, Ctx& context, Channel<Message<input_dim>, depth>* upward): layer(network.head()), context(context), upward(upward), forward(), backward(), next(network.tail(), context, &backward), thread(&Station::run, this) {}
+    /** Copy constructor (deleted).
+    **/
+    Station(Station const&) = delete;
+    /** Join the station thread, the context must have been stopped.
+    **/
+    ~Station() {
+        thread.join();
+    }
+public:
+    /** Get the input queue of the station.
+     * @return Input queue
+    **/
+    Channel<Message<input_dim>, depth>& inbox() {
+        return forward;
+    }
+};
+template<class Out, class Ctx, class Policy, nat_t input_dim, nat_t output_dim> class Station<Out, Ctx, Policy, input_dim, output_dim> final {
+private:
+    constexpr static nat_t depth = Ctx::depth;
+private:
+    typename Kind<typename Policy::last, input_dim, output_dim>::type& layer; // Owned layer
+    Ctx& context; // Shared context
+    Channel<Message<input_dim>, depth>* upward; // Backward queue of the previous station (null for the first station)
+    Channel<Message<input_dim>, depth> forward; // Inputs from the previous station
+    ::std::thread thread; // Station thread
+private:
+    /** Station thread entry point, checks the outputs then starts the backward pass of the out-of-bounds samples.
+    **/
+    void run() {
+        Message<input_dim> input;
+        Message<input_dim> error_out;
+        Vector<output_dim> output;
+        Vector<output_dim> sums;
+        Vector<output_dim> error;
+        nat_t idle = 0;
+        while (!context.stop.load(::std::memory_order_acquire)) {
+            if (!forward.pop(input)) {
+                if (++idle >= Ctx::spin_count) {
+                    context.park([this]() { return !forward.empty(); });
+                    idle = 0;
+                }
+                continue;
+            }
+            idle = 0;
+            nat_t slot = input.id % depth;
+            Vector<output_dim> const& expected = *context.expected[slot];
+            Vector<output_dim> const& margin   = *context.margin[slot];
+            if (Out::transfert) {
+                layer.compute(input.data, output, &sums);
+            } else { // Output computed by the stage from the sums only
+                layer.sum(input.data, sums);
+            }
+            Out::activate(sums, output);
+            if (!any(abs(expected - output) > margin)) { // In bounds
+                context.complete(input.id);
+                continue;
+            }
+            context.corrected.fetch_add(1, ::std::memory_order_relaxed);
+            context.optim.step();
+            error = expected - output;
+            layer.template correct<Out::transfert>(input.data, sums, error, context.optim, context.limit / input_dim, upward ? &error_out.data : null);
+            if (upward) {
+                error_out.id = input.id;
+                context.send(*upward, error_out);
+            } else {
+                context.complete(input.id);
+            }
+        }
+    }
+public:
+    /** Start the station.
+     * @param network Network whose layer is owned by this station
+     * @param context Shared context
+     * @param upward  Backward queue of the previous station (null for the first station)
+    **/
+    Station(BasicNetwork<Policy, input_dim, output_dim>& network, Ctx& context, Channel<Message<input_dim>, depth>* upward): layer(network.head()), context(context), upward(upward), forward(), thread(&Station::run, this) {}
+    /** Copy constructor (deleted).
+    **/
+    Station(Station const&) = delete;
+    /** Join the station thread, the context must have been stopped.
+    **/
+    ~Station() {
+        thread.join();
+    }
+public:
+    /** Get the input queue of the station.
+     * @return Input queue
+    **/
+    Channel<Message<input_dim>, depth>& inbox() {
+        return forward;
+    }
+};
+
+/** First dimension of a list.
+**/
+template<nat_t first, nat_t... others> class First final {
+public:
+    constexpr static nat_t value = first;
+};
+
+/** Last dimension of a list.
+**/
+template<nat_t first, nat_t... others> class Last final {
+public:
+    constexpr static nat_t value = Last<others...>::value;
+};
+template<nat_t first> class Last<first> final {
+public:
+    constexpr static nat_t value = first;
+};
+
+}
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Pipeline-parallel training of a network, one thread per layer.
+ * Samples flow forward then, when out of their bounds, backward through the layers, the forward and backward passes
+ * of different samples running at the same time. A sample is thus corrected with weights already updated by the
+ * samples issued before it but not yet back, at most '2 * layers' samples being in flight.
+ * Optimizer updates of different layers run concurrently, and 'step' is called by the last station.
+ * @param Out    Output stage
+ * @param Optim  Optimizer type
+ * @param Policy Activation policy
+ * @param ...    Input/output vector dimensions
+**/
+template<class Out, class Optim, class Policy, nat_t... dims> class Pipeline final {
+    static_assert(Optim::concurrent, "Optimizer cannot be used by several layers at once");
+private:
+    constexpr static nat_t input_dim  = Pipelined::First<dims...>::value;
+    constexpr static nat_t output_dim = Pipelined::Last<dims...>::value;
+    constexpr static nat_t depth = 2 * (sizeof...(dims) - 1); // Samples in flight
+    using Ctx = Pipelined::Context<Optim, output_dim, depth>;
+private:
+    Ctx context; // Shared context
+    Pipelined::Station<Out, Ctx, Policy, dims...> stations; // Stations
+    nat_t issued; // Number of issued samples
+public:
+    /** Start the stations.
+     * @param network Network to correct, must not be used elsewhere while the pipeline exists
+     * @param optim   Optimizer to use
+     * @param limit   Weight absolute value limit times input synapses (optional, <= 0 for none)
+    **/
+    Pipeline(BasicNetwork<Policy, dims...>& network, Optim& optim, val_t limit = 0): context(optim, limit), stations(network, context, null), issued(0) {}
+    /** Copy constructor (deleted).
+    **/
+    Pipeline(Pipeline const&) = delete;
+    /** Complete the samples in flight, then stop the stations.
+    **/
+    ~Pipeline() {
+        drain();
+        context.halt();
+    }
+public:
+    /** Submit a sample, waiting for a free slot.
+     * @param input    Input vector
+     * @param expected Expected output vector, must live until the next 'drain'
+     * @param margin   Tolerated margin vector, must live until the next 'drain'
+    **/
+    void submit(Vector<input_dim> const& input, Vector<output_dim> const& expected, Vector<output_dim> const& margin) {
+        nat_t slot = issued % depth;
+        for (nat_t i = 0; context.busy[slot].load(::std::memory_order_acquire); i++) {
+            if (i >= Ctx::spin_count)
+                ::std::this_thread::yield();
+        }
+        context.busy[slot].store(true, ::std::memory_order_relaxed);
+        context.expected[slot] = &expected;
+        context.margin[slot]   = &margin;
+        Pipelined::Message<input_dim> message;
+        message.id   = issued++;
+        message.data = input;
+        context.send(stations.inbox(), message);
+    }
+    /** Wait for every submitted sample to complete.
+     * @return Number of samples corrected since the last call
+    **/
+    nat_t drain() {
+        for (nat_t slot = 0; slot < depth; slot++) {
+            for (nat_t i = 0; context.busy[slot].load(::std::memory_order_acquire); i++) {
+                if (i >= Ctx::spin_count)
+                    ::std::this_thread::yield();
+            }
+        }
+        return context.corrected.exchange(0);
+    }
+};
+
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Pipeline ▔
+// ▁ Learning discipline ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+
+/** Bounded lock-free queue of labelled samples, filled by one producer thread while the network is trained.
+ * @param input_dim  Input vector dimensions
+ * @param output_dim Output vector dimensions
+ * @param capacity   Maximal number of pending samples
+**/
+template<nat_t input_dim, nat_t output_dim, nat_t capacity = 256> class Inbox final {
+public:
+    /** Pending sample.
+    **/
+    class Sample final {
+    public:
+        Vector<input_dim>  input;    // Input vector
+        Vector<output_dim> expected; // Expected output vector
+        Vector<output_dim> margin;   // Tolerated margin
+    };
+private:
+    Pipelined::Channel<Sample, capacity> channel; // Pending samples
+public:
+    /** Push a sample, producer side.
+     * @param sample Sample to push
+     * @return True on success, false if full
+    **/
+    bool push(Sample const& sample) {
+        return channel.push(sample);
+    }
+    /** Pop a sample, consumer side.
+     * @param sample Popped sample (output)
+     * @return True on success, false if none pending
+    **/
+    bool pop(Sample& sample) {
+        return channel.pop(sample);
+    }
+};
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Correct the network one time on a constraint, if its output is out of bounds.
+ * @param Out       Output stage
+ * @param network   Neural network to correct
+ * @param workspace Workspace of the network
+ * @param input     Input vector
+ * @param expected  Expected output vector
+ * @param margin    Tolerated margin vector
+ * @param optim     Optimizer to use
+ * @param limit     Weight absolute value limit times input synapses (<= 0 for none)
+ * @return True if on bounds, false if a correction has been applied
+**/
+template<class Out, class Optim, class Policy, nat_t input_dim, nat_t output_dim, nat_t... implicit_dims> bool enforce(BasicNetwork<Policy, implicit_dims...>& network, Workspace<implicit_dims...>& workspace, Vector<input_dim> const& input, Vector<output_dim> const& expected, Vector<output_dim> const& margin, Optim& optim, val_t limit) {
+    Vector<output_dim>& output = workspace.result(); // Output vector, then error vector
+    network.template compute<Out>(input, output, workspace);
+    if (!any(abs(expected - output) > margin)) // In bounds
+        return true;
+    optim.step();
+    network.template correct<Out>(input, expected, output, workspace, optim, limit);
+    return false;
+}
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Learning discipline.
+ * @param input_dim  Input vector dimensions
+ * @param output_dim Output vector dimensions
+ * @param Alloc      Allocation policy for the constraints
+**/
+template<nat_t input_dim, nat_t output_dim, class Alloc = Allocator::Heap> class Learning final {
+    static_assert(input_dim > 0, "Invalid input vector dimension");
+    static_assert(output_dim > 0, "Invalid output vector dimension");
+private:
+    /** Input vector type.
+    **/
+    using Input  = Vector<input_dim>;
+    /** Output vector type.
+    **/
+    using Output = Vector<output_dim>;
+    /** Input, and expected output, with error margin.
+    **/
+    class Constraint final {
+    private:
+        Input  input;    // Input vector
+        Output expected; // Expected output vector
+        Output margin;   // Tolerated margin
+    public:
+        /** Build a new constraint.
+         * @param input    Input vector
+         * @param expected Expected output vector
+         * @param margin   Tolerated margin vector
+        **/
+        Constraint(Input& input, Output& expected, Output& margin): input(input), expected(expected), margin(margin) {}
+    public:
+        /** Check equality between input vectors.
+         * @param input Input vector to compare with
+         * @return True if the stored input vector is equal to the given one, false otherwise
+        **/
+        bool match(Input& input) {
+            return this->input == input;
+        }
+        /** Correct the network one time, if needed.
+         * @param Out       Output stage
+         * @param network   Neural network to correct
+         * @param workspace Workspace of the network
+         * @param optim     Optimizer to use
+         * @param limit     Weight absolute value limit times input synapses (optional, <= 0 for none)
+         * @return True if on bounds, false if a correction has been applied
+        **/
+        template<class Out, class Optim, class Policy, nat_t... implicit_dims> bool correct(BasicNetwork<Policy, implicit_dims...>& network, Workspace<implicit_dims...>& workspace, Optim& optim, val_t limit = 0) {
+            return enforce<Out>(network, workspace, input, expected, margin, optim, limit);
+        }
+        /** Submit the constraint to a pipeline, corrected there if needed.
+         * @param pipeline Pipeline to submit to
+        **/
+        template<class Pipe> void submit(Pipe& pipeline) const {
+            pipeline.submit(input, expected, margin);
+        }
+    public:
+        /** Print constraint to the given stream.
+         * @param ostr Output stream
+        **/
+        void print(::std::ostream& ostr) {
+            ostr << "{ ";
+            input.print(ostr);
+            ostr << ", ";
+            expected.print(ostr);
+            ostr << ", ";
+            margin.print(ostr);
+            ostr << " }";
+        }
+    };
+private:
+    Pool<Constraint, Alloc> constraints; // Constraints set, never moved
+    ::std::vector<Constraint*> order; // Constraints order
+    ::std::random_device device; // Random device
+    ::std::default_random_engine engine; // Default engine
+public:
+    /** Build an empty learning discipline.
+    **/
+    Learning(): constraints(), order(), device(), engine(device()) {}
+public:
+    /** Add a constraint to the discipline, not checked for duplicate.
+     * @param input  Input vector
+     * @param output Expected output vector
+     * @param margin Tolerated margin vector
+    **/
+    void add(Input& input, Output& output, Output& margin) {
+        order.push_back(&constraints.emplace(input, output, margin));
+    }
+    /** Tell if a constraint exists based on the input vector.
+     * @param input Input vector of the constraint to find
+     * @return True if a matching constraint has been found, false otherwise
+    **/
+    bool has(Input& input) {
+        for (Constraint* constraint: order)
+            if (constraint->match(input))
+                return true;
+        return false;
+    }
+    /** Remove a constraint based on the input vector.
+     * @param input Input vector of the constraint to remove
+    **/
+    void remove(Input& input) {
+        for (auto pos = order.begin(); pos != order.end(); pos++) {
+            if ((*pos)->match(input)) {
+                Constraint* slot = *pos;
+                Constraint* last = &constraints[constraints.size() - 1];
+                order.erase(pos);
+                if (slot != last) { // Move the last constraint into the freed slot
+                    *slot = *last;
+                    *::std::find(order.begin(), order.end(), last) = slot;
+                }
+                constraints.pop();
+                return;
+            }
+        }
+    }
+    /** Remove all constraints.
+    **/
+    void reset() {
+        order.clear();
+        constraints.clear();
+    }
+    /** Return the number of constraints.
+     * @return Number of constraints
+    **/
+    nat_t size() const {
+        return static_cast<nat_t>(order.size());
+    }
+    /** Add the pending samples of an inbox as constraints, must not run concurrently with 'correct'.
+     * @param inbox Inbox to drain, consumer side
+     * @return Number of constraints added
+    **/
+    template<nat_t capacity> nat_t merge(Inbox<input_dim, output_dim, capacity>& inbox) {
+        typename Inbox<input_dim, output_dim, capacity>::Sample sample;
+        nat_t count = 0;
+        while (inbox.pop(sample)) {
+            add(sample.input, sample.expected, sample.margin);
+            count++;
+        }
+        return count;
+    }
+public:
+    /** Correct the network one time, so that each output is near enough from its expected output, in a workspace allocated for this call only.
+     * @param Out     Output stage
+     * @param network Neural network to correct
+     * @param optim   Optimizer to use
+     * @param limit   Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @return Number of out-bounds constraints
+    **/
+    template<class Out = Stage::Quadratic, class Optim, class Policy, nat_t... implicit_dims> nat_t correct(BasicNetwork<Policy, implicit_dims...>& network, Optim& optim, val_t limit = 0) {
+        Allocated<Workspace<implicit_dims...>> workspace; // Off the stack, whatever the layer widths
+        return correct<Out>(network, *workspace, optim, limit);
+    }
+    /** Correct the network one time, in the given workspace.
+     * @param Out       Output stage
+     * @param network   Neural network to correct
+     * @param workspace Workspace of the network
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @return Number of out-bounds constraints
+    **/
+    template<class Out = Stage::Quadratic, class Optim, class Policy, nat_t... implicit_dims> nat_t correct(BasicNetwork<Policy, implicit_dims...>& network, Workspace<implicit_dims...>& workspace, Optim& optim, val_t limit = 0) {
+        profiled_scope(Profiling::epoch, Timing::name("epoch", { implicit_dims... }), order.size());
+        nat_t count = 0;
+        for (Constraint* constraint: order) {
+            if (!constraint->template correct<Out>(network, workspace, optim, limit)) // Not in-bounds
+                count++;
+        }
+        return count;
+    }
+    /** Correct the network one time, the pending samples of an inbox being added as constraints between two corrections, in a workspace allocated for this call only.
+     * The samples merged during the pass are corrected in the same pass, after the constraints already there.
+     * @param Out     Output stage
+     * @param network Neural network to correct
+     * @param inbox   Inbox to drain, consumer side
+     * @param optim   Optimizer to use
+     * @param limit   Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @param first   First constraint to correct, in order (optional, e.g. to correct the last merged ones only)
+     * @return Number of out-bounds constraints
+    **/
+    template<class Out = Stage::Quadratic, class Optim, class Policy, nat_t capacity, nat_t... implicit_dims> nat_t correct(BasicNetwork<Policy, implicit_dims...>& network, Inbox<input_dim, output_dim, capacity>& inbox, Optim& optim, val_t limit = 0, nat_t first = 0) {
+        Allocated<Workspace<implicit_dims...>> workspace; // Off the stack, whatever the layer widths
+        return correct<Out>(network, *workspace, inbox, optim, limit, first);
+    }
+    /** Correct the network one time in the given workspace, the pending samples of an inbox being added as constraints between two corrections.
+     * @param Out       Output stage
+     * @param network   Neural network to correct
+     * @param workspace Workspace of the network
+     * @param inbox     Inbox to drain, consumer side
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @param first     First constraint to correct, in order (optional)
+     * @return Number of out-bounds constraints
+    **/
+    template<class Out = Stage::Quadratic, class Optim, class Policy, nat_t capacity, nat_t... implicit_dims> nat_t correct(BasicNetwork<Policy, implicit_dims...>& network, Workspace<implicit_dims...>& workspace, Inbox<input_dim, output_dim, capacity>& inbox, Optim& optim, val_t limit = 0, nat_t first = 0) {
+        profiled_scope(Profiling::epoch, Timing::name("epoch", { implicit_dims... }), order.size() - first);
+        nat_t count = 0;
+        for (size_t i = first; i < order.size(); i++) { // Indexed, the merged constraints being appended meanwhile
+            merge(inbox);
+            if (!order[i]->template correct<Out>(network, workspace, optim, limit))
+                count++;
+        }
+        return count;
+    }
+    /** Correct the network one time, plain gradient descent.
+     * @param Out     Output stage
+     * @param network Neural network to correct
+     * @param eta     Correction factor
+     * @param limit   Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @return Number of out-bounds constraints
+    **/
+    template<class Out = Stage::Quadratic, class Policy, nat_t... implicit_dims> nat_t correct(BasicNetwork<Policy, implicit_dims...>& network, val_t eta, val_t limit = 0) {
+        Optimizer::Plain optim(eta);
+        return correct<Out>(network, optim, limit);
+    }
+    /** Correct the network one time through a pipeline, so that each output is near enough from its expected output.
+     * @param pipeline Pipeline of the network to correct
+     * @return Number of out-bounds constraints
+    **/
+    template<class Out, class Optim, class Policy, nat_t... implicit_dims> nat_t correct(Pipeline<Out, Optim, Policy, implicit_dims...>& pipeline) {
+        profiled_scope(Profiling::epoch, Timing::name("pipelined epoch", { implicit_dims... }), order.size()); // Submitting thread only
+        for (Constraint* constraint: order)
+            constraint->submit(pipeline);
+        return pipeline.drain();
+    }
+    /** Correct the network one time through a pipeline, the pending samples of an inbox being added as constraints between two submissions.
+     * @param pipeline Pipeline of the network to correct
+     * @param inbox    Inbox to drain, consumer side
+     * @param first    First constraint to correct, in order (optional)
+     * @return Number of out-bounds constraints
+    **/
+    template<class Out, class Optim, class Policy, nat_t capacity, nat_t... implicit_dims> nat_t correct(Pipeline<Out, Optim, Policy, implicit_dims...>& pipeline, Inbox<input_dim, output_dim, capacity>& inbox, nat_t first = 0) {
+        profiled_scope(Profiling::epoch, Timing::name("pipelined epoch", { implicit_dims... }), order.size() - first); // Submitting thread only
+        for (size_t i = first; i < order.size(); i++) { // Constraints never moved, so the ones in flight stay valid
+            merge(inbox);
+            order[i]->submit(pipeline);
+        }
+        return pipeline.drain();
     }
-    /** Vector comparison.
-     * @param x Vector to compare
-     * @return True if equal, false otherwise
+    /** Randomize constraints order, constraints themselves are not moved.
     **/
-    bool operator==(Vector<dim> const& x) const {
-        for (nat_t i = 0; i < dim; i++)
-            if (x.get(i) != get(i))
-                return false;
-        return true;
+    void shuffle() {
+        ::std::shuffle(order.begin(), order.end(), engine);
     }
-public:
-    /** Return the size of the structure.
-     * @return Size of the structure, in bytes
+    /** Seed the random engine used to shuffle the constraints, for reproducible runs.
+     * @param value Seed value
     **/
-    static constexpr size_t size() {
-        return dim * sizeof(val_t);
+    void seed(uint64_t value) {
+        engine.seed(static_cast<::std::default_random_engine::result_type>(value));
     }
-    /** Load vector data.
-     * @param input Serialized input
+public:
+    /** Save the training state (constraints order, random engine state), not the constraints themselves.
+     * @param ostr Output stream
     **/
-    void load(Serializer::Input& input) {
-        for (nat_t i = 0; i < dim; i++)
-            set(i, input.load());
+    void save(::std::ostream& ostr) {
+        using char_type = ::std::remove_reference<decltype(ostr)>::type::char_type;
+        ::std::ostringstream sstr; // Random engine state
+        sstr << engine;
+        ::std::string state = sstr.str();
+        uint64_t count = state.size();
+        ostr.write(reinterpret_cast<char_type const*>(&count), sizeof(count));
+        ostr.write(state.data(), count);
+        count = order.size();
+        ostr.write(reinterpret_cast<char_type const*>(&count), sizeof(count));
+        for (Constraint* constraint: order) {
+            uint64_t pos = constraints.index(constraint);
+            ostr.write(reinterpret_cast<char_type const*>(&pos), sizeof(pos));
+        }
     }
-    /** Store vector data.
-     * @param output Serialized output
+    /** Restore a training state saved with the same constraints, added in the same order.
+     * @param istr Input stream
+     * @return True on success, false otherwise
     **/
-    void store(Serializer::Output& output) const {
-        for (nat_t i = 0; i < dim; i++)
-            output.store(get(i));
+    bool restore(::std::istream& istr) {
+        using char_type = ::std::remove_reference<decltype(istr)>::type::char_type;
+        uint64_t count;
+        istr.read(reinterpret_cast<char_type*>(&count), sizeof(count));
+        if (unlikely(!istr))
+            return false;
+        ::std::string state(count, '\0');
+        istr.read(&state[0], count);
+        istr.read(reinterpret_cast<char_type*>(&count), sizeof(count));
+        if (unlikely(!istr || count != order.size()))
+            return false;
+        ::std::vector<Constraint*> restored(order.size()); // Parsed aside, the current state being kept on failure
+        ::std::vector<bool> seen(order.size(), false);      // Positions already restored, for a permutation
+        for (Constraint*& constraint: restored) {
+            uint64_t pos;
+            istr.read(reinterpret_cast<char_type*>(&pos), sizeof(pos));
+            if (unlikely(!istr || pos >= order.size() || seen[pos]))
+                return false;
+            seen[pos] = true;
+            constraint = &constraints[pos];
+        }
+        ::std::default_random_engine resumed;
+        ::std::istringstream sstr(state);
+        if (unlikely(!(sstr >> resumed)))
+            return false;
+        order.swap(restored);
+        engine = resumed;
+        return true;
     }
 public:
-    /** Print vector to the given stream.
+    /** Print learning discipline to the given stream.
      * @param ostr Output stream
     **/
-    void print(::std::ostream& ostr) const {
-        ostr << "{ " << get(0);
-        for (nat_t i = 1; i < dim; i++)
-            ostr << ", " << get(i);
-        ostr << " }";
+    void print(::std::ostream& ostr) {
+        if (order.empty()) {
+            ostr << "{}";
+            return;
+        }
+        ostr << "{" << ::std::endl << "\t";
+        bool first = true;
+        for (Constraint* constraint: order) {
+            if (first) {
+                first = false;
+                constraint->print(ostr);
+            } else {
+                ostr << "," << ::std::endl << "\t";
+                constraint->print(ostr);
+            }
+        }
+        ostr << ::std::endl << "}";
     }
 };
 
 }
 
 // ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
-// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Simple vector ▔
-// ▁ Neural Network ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Learning discipline ▔
+// ▁ Streaming ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
 
 namespace StaticNet {
 
-/** Single neuron with synapses.
- * @param input_dim Input vector dimension
+#if STATICNET_MMAP
+/** Read-only mapping of a whole file, paged in on demand, with explicit readahead hints.
 **/
-template<nat_t input_dim> class Neuron final {
-    static_assert(input_dim > 0, "Invalid input vector dimension");
-public:
-    Vector<input_dim> weight; // Input weight vector
-    val_t bias; // Bias
-public:
-    /** Randomize the weight vector.
-     * @param rand Randomizer to use
+class MappedFile final {
+private:
+    int    fd;     // File descriptor, kept for the hints
+    size_t length; // File size, in bytes
+    uint8_t const* base; // Mapping base address
+private:
+    /** Page-align a range of the file, clamped to the file size.
+     * @param offset Range offset, in bytes (updated)
+     * @param count  Range size, in bytes (updated)
     **/
-    void randomize(Randomizer& rand) {
-        for (nat_t i = 0; i < input_dim; i++)
-            weight.set(i, rand.get());
-        bias = rand.get();
+    void align(size_t& offset, size_t& count) const {
+        size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t end  = ::std::min(offset + count, length);
+        offset = offset / page * page;
+        count  = end > offset ? end - offset : 0;
     }
-    /** Compute the output of the neuron.
-     * @param input   Input vector
-     * @param trans   Transfert function
-     * @param out_sum Sum of weighted inputs (optional)
-     * @return Output scalar
+public:
+    /** Map a file.
+     * @param path Path to the file to map
     **/
-    val_t compute(Vector<input_dim> const& input, Transfert const& trans, val_t* out_sum = null) const {
-        val_t sum = weight * input + bias;
-        if (out_sum)
-            *out_sum = sum;
-        return trans(sum);
+    MappedFile(char const* path): fd(::open(path, O_RDONLY)), length(0), base(null) {
+        if (fd < 0)
+            throw ::std::runtime_error("Unable to open '" + ::std::string(path) + "' for reading");
+        off_t size = ::lseek(fd, 0, SEEK_END);
+        void* addr = (size > 0 ? ::mmap(null, static_cast<size_t>(size), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throw ::std::runtime_error("Unable to map '" + ::std::string(path) + "'");
+        }
+        length = static_cast<size_t>(size);
+        base   = static_cast<uint8_t const*>(addr);
+        ::madvise(addr, length, MADV_RANDOM); // Accesses are hinted explicitly
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
     }
-    /** Correct the weight vector of the neuron.
-     * @param input Input vector
-     * @param sum   Sum of weighted inputs
-     * @param error Sum of weighted errors
-     * @param trans Transfert function
-     * @param eta   Correction factor
-     * @param limit Weight absolute value limit (optional, <= 0 for none)
-     * @return Error scalar
+    /** Copy constructor (deleted).
     **/
-    val_t correct(Vector<input_dim> const& input, val_t sum, val_t error, Transfert const& trans, val_t eta, val_t limit = 0) {
-        val_t err = error * trans.diff(sum);
-        if (limit > 0) { // Limit exists
-            for (nat_t i = 0; i < input_dim; i++) {
-                val_t update = weight.get(i) + eta * err * input.get(i);
-                if (update > limit) {
-                    update = limit;
-                } else if (update < -limit) {
-                    update = -limit;
-                }
-                weight.set(i, update);
-            }
-        } else {
-            for (nat_t i = 0; i < input_dim; i++)
-                weight.set(i, weight.get(i) + eta * err * input.get(i));
-        }
-        bias += eta * err;
-        return err;
+    MappedFile(MappedFile const&) = delete;
+    /** Unmap and close the file.
+    **/
+    ~MappedFile() {
+        ::munmap(const_cast<uint8_t*>(base), length);
+        ::close(fd);
     }
 public:
-    /** Return the size of the structure.
-     * @return Size of the structure, in bytes
+    /** Get the file content.
+     * @return Mapping base address
     **/
-    static constexpr size_t size() {
-        return decltype(weight)::size() + sizeof(val_t);
+    uint8_t const* data() const {
+        return base;
     }
-    /** Load neuron data.
-     * @param input Serialized input
+    /** Get the status of the mapped file, even if it has since been renamed or unlinked.
+     * @param info Status of the file (output)
+     * @return True on success, false otherwise
     **/
-    void load(Serializer::Input& input) {
-        weight.load(input);
-        bias = input.load();
+    bool status(struct ::stat& info) const {
+        return ::fstat(fd, &info) == 0;
     }
-    /** Store vector data.
-     * @param output Serialized output
+    /** Return the file size.
+     * @return File size, in bytes
     **/
-    void store(Serializer::Output& output) const {
-        weight.store(output);
-        output.store(bias);
+    size_t size() const {
+        return length;
     }
-public:
-    /** Print neuron weights to the given stream.
-     * @param ostr Output stream
+    /** Hint that a range of the file will be read soon, so that it is read ahead in the background.
+     * @param offset Range offset, in bytes
+     * @param count  Range size, in bytes
     **/
-    void print(::std::ostream& ostr) const {
-        ostr << "{ ";
-        weight.print(ostr);
-        ostr << ", " << bias << " }";
+    void prefetch(size_t offset, size_t count) const {
+        align(offset, count);
+        if (count == 0)
+            return;
+        ::posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(count), POSIX_FADV_WILLNEED);
+        ::madvise(const_cast<uint8_t*>(base + offset), count, MADV_WILLNEED);
+    }
+    /** Hint that a range of the file will not be read for a while, so that its pages can be dropped.
+     * @param offset Range offset, in bytes
+     * @param count  Range size, in bytes
+    **/
+    void release(size_t offset, size_t count) const {
+        align(offset, count);
+        if (count == 0)
+            return;
+        ::madvise(const_cast<uint8_t*>(base + offset), count, MADV_DONTNEED);
+        ::posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(count), POSIX_FADV_DONTNEED);
     }
 };
+#endif
 
 // ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
 
-/** Layer of neurons.
- * @param input_dim  Input vector dimension
- * @param output_dim Output vector dimension
+/** Abstract sample source, with random access by index.
+ * @param input_dim  Input vector dimensions
+ * @param output_dim Output vector dimensions
 **/
-template<nat_t input_dim, nat_t output_dim> class Layer final {
-    static_assert(input_dim > 0, "Invalid input vector dimension");
-    static_assert(output_dim > 0, "Invalid output vector dimension");
+template<nat_t input_dim, nat_t output_dim> class Source {
+public:
+    /** Virtual destructor, sources being owned through this interface.
+    **/
+    virtual ~Source() {}
+public:
+    /** Return the number of samples.
+     * @return Number of samples
+    **/
+    virtual nat_t size() const = 0;
+    /** Read a sample.
+     * @param index    Sample index
+     * @param input    Input vector (output)
+     * @param expected Expected output vector (output)
+     * @param margin   Tolerated margin vector (output)
+    **/
+    virtual void read(nat_t index, Vector<input_dim>& input, Vector<output_dim>& expected, Vector<output_dim>& margin) = 0;
+    /** Hint that a range of samples will be read soon (optional).
+     * @param first First sample index
+     * @param count Number of samples
+    **/
+    virtual void prefetch(nat_t, nat_t) {}
+    /** Hint that a range of samples will not be read again this epoch (optional).
+     * @param first First sample index
+     * @param count Number of samples
+    **/
+    virtual void release(nat_t, nat_t) {}
+};
+
+/** Learning discipline streaming its constraints from a source, in bounded memory.
+ * Each epoch visits the chunks of the source in a random order, the next chunk being prefetched while the current one
+ * is read, and the samples go through a shuffle buffer: once full, each new sample replaces a random one of the buffer,
+ * which is then used. Every sample is thus used exactly once per epoch.
+ * @param input_dim  Input vector dimensions
+ * @param output_dim Output vector dimensions
+ * @param Alloc      Allocation policy for the shuffle buffer
+**/
+template<nat_t input_dim, nat_t output_dim, class Alloc = Allocator::Heap> class Streaming final {
 private:
-    Transfert const& trans; // Transfert function to use
-    Neuron<input_dim> neurons[output_dim]; // Neurons
+    /** Buffered sample.
+    **/
+    class Sample final {
+    public:
+        Vector<input_dim>  input;    // Input vector
+        Vector<output_dim> expected; // Expected output vector
+        Vector<output_dim> margin;   // Tolerated margin
+    };
+private:
+    Source<input_dim, output_dim>& source; // Sample source
+    nat_t chunk;    // Chunk size, in samples
+    nat_t capacity; // Shuffle buffer size, in samples
+    Pool<Sample, Alloc> buffer; // Shuffle buffer
+    ::std::vector<nat_t> chunks; // Chunks order
+    ::std::random_device device; // Random device
+    ::std::default_random_engine engine; // Default engine
 public:
-    /** Layer constructor.
-     * @param trans Transfert function to use
+    /** Build a streaming discipline.
+     * @param source   Sample source, must outlive the discipline
+     * @param chunk    Chunk size, in samples
+     * @param capacity Shuffle buffer size, in samples (optional, 0 for 4 chunks)
+    **/
+    Streaming(Source<input_dim, output_dim>& source, nat_t chunk, nat_t capacity = 0): source(source), chunk(::std::max<nat_t>(chunk, 1)), capacity(capacity > 0 ? capacity : 4 * this->chunk), buffer(), chunks(), device(), engine(device()) {
+        for (nat_t i = 0; i < this->capacity; i++)
+            buffer.emplace();
+        for (nat_t i = 0; i * this->chunk < source.size(); i++)
+            chunks.push_back(i);
+    }
+    /** Copy constructor (deleted).
     **/
-    Layer(Transfert const& trans): trans(trans) {}
+    Streaming(Streaming const&) = delete;
 public:
-    /** Randomize the layer.
-     * @param rand Randomizer to use
+    /** Correct the network one time over the whole source, so that each output is near enough from its expected output, in a workspace allocated for this call only.
+     * @param Out     Output stage
+     * @param network Neural network to correct
+     * @param optim   Optimizer to use
+     * @param limit   Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @return Number of out-bounds constraints
     **/
-    void randomize(Randomizer& rand) {
-        for (nat_t i = 0; i < output_dim; i++)
-            neurons[i].randomize(rand);
+    template<class Out = Stage::Quadratic, class Optim, class Policy, nat_t... implicit_dims> nat_t correct(BasicNetwork<Policy, implicit_dims...>& network, Optim& optim, val_t limit = 0) {
+        Allocated<Workspace<implicit_dims...>> workspace; // Off the stack, whatever the layer widths
+        return correct<Out>(network, *workspace, optim, limit);
     }
-    /** Compute the output vector of the layer.
-     * @param input   Input vector
-     * @param output  Output vector
-     * @param out_sum Sum of weighted inputs vector (output, optional)
+    /** Correct the network one time over the whole source, in the given workspace.
+     * @param Out       Output stage
+     * @param network   Neural network to correct
+     * @param workspace Workspace of the network
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (optional, <= 0 for none)
+     * @return Number of out-bounds constraints
     **/
-    void compute(Vector<input_dim> const& input, Vector<output_dim>& output, Vector<output_dim>* out_sum = null) const {
-        if (out_sum) {
-            for (nat_t i = 0; i < output_dim; i++) {
-                val_t sum;
-                output.set(i, neurons[i].compute(input, trans, &sum));
-                out_sum->set(i, sum);
+    template<class Out = Stage::Quadratic, class Optim, class Policy, nat_t... implicit_dims> nat_t correct(BasicNetwork<Policy, implicit_dims...>& network, Workspace<implicit_dims...>& workspace, Optim& optim, val_t limit = 0) {
+        profiled_scope(Profiling::epoch, Timing::name("streamed epoch", { implicit_dims... }), source.size());
+        ::std::iota(chunks.begin(), chunks.end(), nat_t(0)); // From the identity, so that the order only depends on the engine state
+        ::std::shuffle(chunks.begin(), chunks.end(), engine);
+        nat_t total = source.size();
+        nat_t count = 0; // Out-bounds constraints
+        nat_t fill  = 0; // Samples in the shuffle buffer
+        for (nat_t k = 0; k < chunks.size(); k++) {
+            nat_t first = chunks[k] * chunk;
+            nat_t last  = ::std::min(first + chunk, total);
+            if (k + 1 < chunks.size()) // Read ahead while this chunk is processed
+                source.prefetch(chunks[k + 1] * chunk, ::std::min(chunk, total - chunks[k + 1] * chunk));
+            for (nat_t index = first; index < last; index++) {
+                if (fill < capacity) { // Filling up
+                    Sample& sample = buffer[fill++];
+                    source.read(index, sample.input, sample.expected, sample.margin);
+                    continue;
+                }
+                Sample& sample = buffer[::std::uniform_int_distribution<nat_t>(0, capacity - 1)(engine)];
+                if (!enforce<Out>(network, workspace, sample.input, sample.expected, sample.margin, optim, limit))
+                    count++;
+                source.read(index, sample.input, sample.expected, sample.margin);
             }
-        } else {
-            for (nat_t i = 0; i < output_dim; i++)
-                output.set(i, neurons[i].compute(input, trans));
+            source.release(first, last - first);
+        }
+        ::std::vector<nat_t> rest(fill); // Drain the buffer in random order
+        for (nat_t i = 0; i < fill; i++)
+            rest[i] = i;
+        ::std::shuffle(rest.begin(), rest.end(), engine);
+        for (nat_t i: rest) {
+            Sample& sample = buffer[i];
+            if (!enforce<Out>(network, workspace, sample.input, sample.expected, sample.margin, optim, limit))
+                count++;
         }
+        return count;
     }
-    /** Correct the neurons of the layer.
-     * @param input     Input vector
-     * @param sums      Sum of weighted inputs vector
-     * @param error     Sum of weighted errors vector
-     * @param eta       Correction factor
-     * @param limit     Weight absolute value limit (optional, <= 0 for none)
-     * @param error_out Sum of weighted errors vector (optional)
+    /** Seed the random engine used to shuffle the samples, for reproducible runs.
+     * @param value Seed value
     **/
-    void correct(Vector<input_dim> const& input, Vector<output_dim> const& sums, Vector<output_dim> const& error, val_t eta, val_t limit = 0, Vector<input_dim>* error_out = null) {
-        if (error_out) { // Error vector asked
-            Vector<output_dim> errors; // Neuron errors
-            for (nat_t i = 0; i < output_dim; i++)
-                errors.set(i, neurons[i].correct(input, sums.get(i), error.get(i), trans, eta, limit));
-            for (nat_t i = 0; i < input_dim; i++) { // Compute error vector
-                val_t sum = 0; // Sum of weighted error
-                for (nat_t j = 0; j < output_dim; j++)
-                    sum += neurons[j].weight.get(i) * errors.get(j);
-                error_out->set(i, sum);
-            }
-        } else {
-            for (nat_t i = 0; i < output_dim; i++)
-                neurons[i].correct(input, sums.get(i), error.get(i), trans, eta, limit);
-        }
+    void seed(uint64_t value) {
+        engine.seed(static_cast<::std::default_random_engine::result_type>(value));
     }
 public:
-    /** Return the size of the structure.
-     * @return Size of the structure, in bytes
+    /** Save the training state (random engine state), not the samples themselves.
+     * @param ostr Output stream
     **/
-    static constexpr size_t size() {
-        size_t size = 0;
-        for (nat_t i = 0; i < output_dim; i++)
-            size += decltype(*neurons)::size();
-        return size;
+    void save(::std::ostream& ostr) {
+        using char_type = ::std::remove_reference<decltype(ostr)>::type::char_type;
+        ::std::ostringstream sstr; // Random engine state
+        sstr << engine;
+        ::std::string state = sstr.str();
+        uint64_t count = state.size();
+        ostr.write(reinterpret_cast<char_type const*>(&count), sizeof(count));
+        ostr.write(state.data(), count);
+        count = source.size();
+        ostr.write(reinterpret_cast<char_type const*>(&count), sizeof(count));
     }
-    /** Load layer data.
-     * @param input Serialized input
+    /** Restore a training state saved with a source of the same size.
+     * @param istr Input stream
+     * @return True on success, false otherwise
     **/
-    void load(Serializer::Input& input) {
-        for (nat_t i = 0; i < output_dim; i++)
-            neurons[i].load(input);
+    bool restore(::std::istream& istr) {
+        using char_type = ::std::remove_reference<decltype(istr)>::type::char_type;
+        uint64_t count;
+        istr.read(reinterpret_cast<char_type*>(&count), sizeof(count));
+        if (unlikely(!istr))
+            return false;
+        ::std::string state(count, '\0');
+        istr.read(&state[0], count);
+        istr.read(reinterpret_cast<char_type*>(&count), sizeof(count));
+        if (unlikely(!istr || count != source.size()))
+            return false;
+        ::std::istringstream(state) >> engine;
+        return true;
     }
-    /** Store vector data.
-     * @param output Serialized output
+};
+
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Streaming ▔
+// ▁ Checkpointing ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+
+/** Replace a file atomically: write to a uniquely named temporary file, sync it, then rename it over the file.
+ * Readers opening the path see either the old or the new content, never a partial one, and concurrent writers never
+ * share a temporary file.
+ * @param path Path of the file to replace
+ * @param data Content to write
+ * @param size Content size, in bytes
+ * @return True on success, false otherwise
+**/
+static inline bool replace(::std::string const& path, void const* data, size_t size) {
+    ::std::string temp = path + ".XXXXXX";
+    int fd = ::mkstemp(&temp[0]);
+    if (unlikely(fd == -1))
+        return false;
+    bool success = ::fchmod(fd, 0644) == 0; // Readable by the other processes, like a file created with 'open'
+    size_t done = 0;
+    while (success && done < size) {
+        ssize_t res = ::write(fd, static_cast<char const*>(data) + done, size - done);
+        if (unlikely(res <= 0)) {
+            success = false;
+            break;
+        }
+        done += static_cast<size_t>(res);
+    }
+    success = success && ::fsync(fd) == 0;
+    success = (::close(fd) == 0) && success;
+    success = success && ::rename(temp.c_str(), path.c_str()) == 0;
+    if (!success) {
+        ::unlink(temp.c_str());
+        return false;
+    }
+    size_t slash = path.rfind('/'); // Sync the directory too, or the rename may not survive a crash
+    int dir = ::open(slash == ::std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash).c_str(), O_RDONLY | O_DIRECTORY);
+    if (unlikely(dir == -1))
+        return false;
+    success = ::fsync(dir) == 0;
+    return (::close(dir) == 0) && success;
+}
+/** Replace a file atomically, see above.
+ * @param path Path of the file to replace
+ * @param data Content to write
+ * @return True on success, false otherwise
+**/
+static inline bool replace(::std::string const& path, ::std::string const& data) {
+    return replace(path, data.data(), data.size());
+}
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Background checkpoint writer.
+ * Snapshots are serialized by the training thread, then written (to a temporary file, synced then renamed over the
+ * checkpoint file) by a writer thread. Only the latest submitted snapshot is written if the writer lags behind.
+**/
+class Checkpointer final {
+private:
+    ::std::string path;    // Checkpoint file path
+    ::std::string pending; // Pending snapshot
+    bool ready;  // Whether a snapshot is pending
+    bool stop;   // Whether the writer must stop once idle
+    bool failed; // Whether at least one write failed
+    ::std::mutex lock; // Lock on the fields above
+    ::std::condition_variable cond; // Wakes up the writer
+    ::std::thread writer; // Writer thread
+private:
+    /** Writer thread entry point.
     **/
-    void store(Serializer::Output& output) const {
-        for (nat_t i = 0; i < output_dim; i++)
-            neurons[i].store(output);
+    void run() {
+        ::std::string data;
+        ::std::unique_lock<::std::mutex> guard(lock);
+        while (true) {
+            cond.wait(guard, [this]() { return ready || stop; });
+            if (!ready) // Stop requested and nothing pending
+                return;
+            data.swap(pending);
+            ready = false;
+            guard.unlock();
+            bool success = replace(path, data);
+            guard.lock();
+            if (!success)
+                failed = true;
+        }
     }
 public:
-    /** Print neuron weights to the given stream.
-     * @param ostr Output stream
+    /** Start the writer thread.
+     * @param path Checkpoint file path
     **/
-    void print(::std::ostream& ostr) const {
-        ostr << "{" << ::std::endl << "\t";
-        neurons[0].print(ostr);
-        for (nat_t i = 1; i < output_dim; i++) {
-            ostr << "," << ::std::endl << "\t";
-            neurons[i].print(ostr);
+    Checkpointer(char const* path): path(path), pending(), ready(false), stop(false), failed(false), lock(), cond(), writer(&Checkpointer::run, this) {}
+    /** Copy constructor (deleted).
+    **/
+    Checkpointer(Checkpointer const&) = delete;
+    /** Write the pending snapshot, if any, then stop the writer thread.
+    **/
+    ~Checkpointer() {
+        {
+            ::std::lock_guard<::std::mutex> guard(lock);
+            stop = true;
         }
-        ostr << ::std::endl << "}";
+        cond.notify_one();
+        writer.join();
+    }
+public:
+    /** Submit a snapshot, never waits for the write.
+     * @param snapshot Snapshot to write, swapped with a reusable buffer
+    **/
+    void submit(::std::string& snapshot) {
+        {
+            ::std::lock_guard<::std::mutex> guard(lock);
+            pending.swap(snapshot);
+            ready = true;
+        }
+        cond.notify_one();
+    }
+    /** Tell whether every write has succeeded so far.
+     * @return True if no write failed, false otherwise
+    **/
+    bool good() {
+        ::std::lock_guard<::std::mutex> guard(lock);
+        return !failed;
     }
 };
 
-// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+}
 
-/** Network of layers, right folded.
- * @param ... Input/output vector dimensions
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Checkpointing ▔
+// ▁ Snapshots ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+
+/** Triple-buffered copies of a network, published by a writer thread and read by another thread, neither ever waiting.
+ * The writer copies into its back buffer then swaps it with the middle one, the reader swaps the middle buffer with
+ * its front one only when a newer copy has been published, so the copy being read is never written.
+ * @param Net   Network type
+ * @param Alloc Allocation policy of the copies
 **/
-template<nat_t input_dim, nat_t inter_dim, nat_t... output_dim> class Network final {
-    static_assert(input_dim > 0, "Invalid input vector dimension");
-    static_assert(inter_dim > 0, "Invalid intermediate vector dimension");
+template<class Net, class Alloc = Allocator::Heap> class Snapshots final {
 private:
-    Layer<input_dim, inter_dim>       layer;  // Input layer
-    Network<inter_dim, output_dim...> layers; // Output network
-public:
-    /** Network constructor.
-     * @param trans Transfert function to use
-    **/
-    Network(Transfert const& trans): layer(trans), layers(trans) {}
+    constexpr static nat_t fresh = 4; // Flag of the middle buffer index, set when newer than the front one
+private:
+    ::std::unique_ptr<Allocated<Net, Alloc>> copies[3]; // Network copies
+    nat_t tags[3]; // Tag of each copy
+    nat_t back;  // Buffer written by the writer
+    nat_t front; // Buffer read by the reader
+    ::std::atomic<nat_t> middle; // Buffer exchanged, with the fresh flag
 public:
-    /** Randomize the network.
-     * @param rand Randomizer to use
+    /** Build the copies.
+     * @param master Network to copy initially, not published
     **/
-    void randomize(Randomizer& rand) {
-        layer.randomize(rand);
-        layers.randomize(rand);
+    Snapshots(Net const& master): tags{ 0, 0, 0 }, back(0), front(1), middle(2) {
+        for (auto& copy: copies)
+            copy.reset(new Allocated<Net, Alloc>(master));
     }
-    /** Compute the output vector of the network.
-     * @param input  Input vector
-     * @param output Output vector
+    /** Copy constructor (deleted).
     **/
-    template<nat_t implicit_dim> void compute(Vector<input_dim> const& input, Vector<implicit_dim>& output) const {
-        Vector<inter_dim> local_output; // Local layer output vector
-        layer.compute(input, local_output);
-        layers.compute(local_output, output);
-    }
-    /** Compute then reduce the quadratic error of the network.
-     * @param input     Input vector
-     * @param expected  Expected output vector
-     * @param error     Error vector (output)
-     * @param eta       Correction factor
-     * @param limit     Weight absolute value limit times input synapses (optional, <= 0 for none)
-     * @param error_out <Reserved>
+    Snapshots(Snapshots const&) = delete;
+public:
+    /** Publish a copy of a network, writer side.
+     * @param network Network to copy, of the same shape
+     * @param tag     Tag of the copy (e.g. epoch number)
     **/
-    template<nat_t implicit_dim> void correct(Vector<input_dim> const& input, Vector<implicit_dim> const& expected, Vector<implicit_dim>& error, val_t eta, val_t limit = 0, Vector<input_dim>* error_out = null) {
-        Vector<inter_dim> local_output;
-        Vector<inter_dim> local_sums;
-        layer.compute(input, local_output, &local_sums);
-        Vector<inter_dim> local_error;
-        layers.correct(local_output, expected, error, eta, limit, &local_error);
-        layer.correct(input, local_sums, local_error, eta, limit / input_dim, error_out);
+    void publish(Net const& network, nat_t tag) {
+        **copies[back] = network;
+        tags[back] = tag;
+        back = middle.exchange(back | fresh, ::std::memory_order_acq_rel) & ~fresh;
     }
-public:
-    /** Return the size of the structure.
-     * @return Size of the structure, in bytes
+    /** Get the latest published copy, reader side.
+     * @return Latest copy, null if none has been published since the last call
     **/
-    static constexpr size_t size() {
-        return decltype(layer)::size() + decltype(layers)::size();
+    Net const* acquire() {
+        if (!(middle.load(::std::memory_order_relaxed) & fresh))
+            return null;
+        front = middle.exchange(front, ::std::memory_order_acq_rel) & ~fresh;
+        return &**copies[front];
     }
-    /** Load layer data.
-     * @param input Serialized input
+    /** Get the tag of the copy last acquired, reader side.
+     * @return Tag of the copy
     **/
-    void load(Serializer::Input& input) {
-        layer.load(input);
-        layers.load(input);
+    nat_t tag() const {
+        return tags[front];
     }
-    /** Store vector data.
-     * @param output Serialized output
+};
+
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Snapshots ▔
+// ▁ Ensemble ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace StaticNet {
+namespace Combine {
+
+/** Average of the member outputs.
+**/
+class Average final {
+public:
+    /** Combine the member outputs.
+     * @param outputs Member output vectors
+     * @param count   Number of members
+     * @param output  Combined output vector
     **/
-    void store(Serializer::Output& output) const {
-        layer.store(output);
-        layers.store(output);
+    template<nat_t dim> static void reduce(Vector<dim> const* outputs, nat_t count, Vector<dim>& output) {
+        output = outputs[0];
+        for (nat_t k = 1; k < count; k++)
+            output += outputs[k];
+        output = output * (val_t(1) / count);
     }
+};
+
+/** Majority vote over the largest output of each member, ties broken by the average of the outputs.
+ * Each coordinate of the combined output is the share of the votes, the winner getting an extra half vote.
+**/
+class Vote final {
 public:
-    /** Print neuron weights to the given stream.
-     * @param ostr Output stream
+    /** Combine the member outputs.
+     * @param outputs Member output vectors
+     * @param count   Number of members
+     * @param output  Combined output vector
     **/
-    void print(::std::ostream& ostr) const {
-        layer.print(ostr);
-        ostr << ", ";
-        layers.print(ostr);
+    template<nat_t dim> static void reduce(Vector<dim> const* outputs, nat_t count, Vector<dim>& output) {
+        Vector<dim> average;
+        Average::reduce(outputs, count, average);
+        for (nat_t i = 0; i < dim; i++)
+            output.set(i, 0);
+        for (nat_t k = 0; k < count; k++) {
+            nat_t guess = 0;
+            for (nat_t i = 1; i < dim; i++)
+                if (outputs[k].get(i) > outputs[k].get(guess))
+                    guess = i;
+            output.set(guess, output.get(guess) + 1);
+        }
+        nat_t best = 0;
+        for (nat_t i = 1; i < dim; i++)
+            if (output.get(i) > output.get(best) || (output.get(i) == output.get(best) && average.get(i) > average.get(best)))
+                best = i;
+        output.set(best, output.get(best) + val_t(0.5));
+        output = output * (val_t(1) / count);
     }
 };
-template<nat_t input_dim, nat_t output_dim> class Network<input_dim, output_dim> final {
-    static_assert(input_dim > 0, "Invalid input vector dimension");
-    static_assert(output_dim > 0, "Invalid output vector dimension");
+
+}
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** Ensemble of same-shape networks, evaluated in one pass.
+ * The first layers of the members are stacked into one wider layer, so the input is read (and its support built)
+ * once for all the members, then each member computes its output network and the outputs are combined.
+ * @param Net   Member network type
+ * @param count Number of members
+ * @param Comb  Combination of the member outputs
+**/
+template<class Net, nat_t count, class Comb = Combine::Average> class Ensemble;
+template<class Policy, nat_t input_dim, nat_t inter_dim, nat_t... output_dim, nat_t count, class Comb> class Ensemble<BasicNetwork<Policy, input_dim, inter_dim, output_dim...>, count, Comb> final {
+    static_assert(sizeof...(output_dim) > 0, "Ensembles of single-layer networks are not supported");
+    static_assert(count > 0, "Invalid number of members");
+public:
+    /** Member network type.
+    **/
+    using Member = BasicNetwork<Policy, input_dim, inter_dim, output_dim...>;
+private:
+    using Tail = BasicNetwork<typename Policy::tail, inter_dim, output_dim...>;
+    constexpr static nat_t last_dim = Pipelined::Last<output_dim...>::value;
 private:
-    Layer<input_dim, output_dim> layer; // Input/output layer
+    Layer<input_dim, count * inter_dim, typename Policy::head> layer; // First layers of the members, stacked
+    Tail tails[count]; // Output networks of the members
+private:
+    /** Ensemble constructor, one transfert function argument per output network.
+     * @param trans Transfert function to use
+    **/
+    template<nat_t... ids> Ensemble(Transfert const& trans, ::std::integer_sequence<nat_t, ids...>): layer(trans), tails{ (static_cast<void>(ids), trans)... } {}
 public:
-    /** Network constructor.
+    /** Ensemble constructor, for table-free activation functions.
+    **/
+    Ensemble(): layer(), tails() {}
+    /** Ensemble constructor.
      * @param trans Transfert function to use
     **/
-    Network(Transfert const& trans): layer(trans) {}
+    Ensemble(Transfert const& trans): Ensemble(trans, ::std::make_integer_sequence<nat_t, count>()) {}
 public:
-    /** Randomize the network.
-     * @param rand Randomizer to use
+    /** Compute the combined output vector of the members.
+     * @param Out    Output stage of the members
+     * @param input  Input vector
+     * @param output Combined output vector
     **/
-    void randomize(Randomizer& rand) {
-        layer.randomize(rand);
+    template<class Out = Stage::Quadratic> void compute(Vector<input_dim> const& input, Vector<last_dim>& output) const {
+        timed_scope(Timing::name("ensemble", { count, input_dim, inter_dim, output_dim... }));
+        Vector<count * inter_dim> hidden; // Stacked first layer output vector
+        layer.compute(input, hidden);
+        combine<Out>(hidden, output);
     }
-    /** Compute the output vector of the network.
-     * @param input  Input vector
-     * @param output Output vector
+    /** Compute the combined output vector of the members, the stacked layer being split between the workers.
+     * @param Out     Output stage of the members
+     * @param input   Input vector
+     * @param output  Combined output vector
+     * @param workers Workers to use
     **/
-    void compute(Vector<input_dim> const& input, Vector<output_dim>& output) const {
-        layer.compute(input, output);
+    template<class Out = Stage::Quadratic> void compute(Vector<input_dim> const& input, Vector<last_dim>& output, Workers& workers) const {
+        timed_scope(Timing::name("ensemble", { count, input_dim, inter_dim, output_dim... }));
+        Vector<count * inter_dim> hidden; // Stacked first layer output vector
+        layer.compute(input, hidden, workers);
+        combine<Out>(hidden, output);
     }
-    /** Compute then reduce the quadratic error of the network.
-     * @param input     Input vector
-     * @param expected  Expected output vector
-     * @param error     Error vector (output)
-     * @param eta       Correction factor
-     * @param limit     Weight absolute value limit times input synapses (optional, <= 0 for none)
-     * @param error_out <Reserved>
+private:
+    /** Compute the output networks of the members from the stacked layer output, then combine their outputs.
+     * @param Out    Output stage of the members
+     * @param hidden Stacked first layer output vector
+     * @param output Combined output vector
     **/
-    void correct(Vector<input_dim> const& input, Vector<output_dim> const& expected, Vector<output_dim>& error, val_t eta, val_t limit = 0, Vector<input_dim>* error_out = null) {
-        Vector<output_dim> local_output;
-        Vector<output_dim> local_sums;
-        layer.compute(input, local_output, &local_sums);
-        for (nat_t i = 0; i < output_dim; i++)
-            error.set(i, expected.get(i) - local_output.get(i));
-        layer.correct(input, local_sums, error, eta, limit / input_dim, error_out);
+    template<class Out> void combine(Vector<count * inter_dim> const& hidden, Vector<last_dim>& output) const {
+        Vector<inter_dim> part;          // First layer output vector of a member
+        Vector<last_dim> outputs[count]; // Member output vectors
+        for (nat_t k = 0; k < count; k++) {
+            for (nat_t j = 0; j < inter_dim; j++)
+                part.set(j, hidden.get(k * inter_dim + j));
+            tails[k].template compute<Out>(part, outputs[k]);
+        }
+        Comb::reduce(outputs, count, output);
     }
 public:
+    /** Copy the weights of a network into a member.
+     * @param id      Member id
+     * @param network Network to copy, of the member shape
+    **/
+    void set(nat_t id, Member const& network) {
+        for (nat_t j = 0; j < inter_dim; j++)
+            layer.neuron(id * inter_dim + j) = network.head().neuron(j);
+        tails[id] = network.tail();
+    }
     /** Return the size of the structure.
      * @return Size of the structure, in bytes
     **/
     static constexpr size_t size() {
-        return decltype(layer)::size();
+        return decltype(layer)::size() + count * Tail::size();
     }
-    /** Load layer data.
+    /** Load the data of a member, serialized as a member network.
+     * @param id    Member id
      * @param input Serialized input
     **/
-    void load(Serializer::Input& input) {
-        layer.load(input);
+    void load(nat_t id, Serializer::Input& input) {
+        for (nat_t j = 0; j < inter_dim; j++)
+            layer.neuron(id * inter_dim + j).load(input);
+        tails[id].load(input);
     }
-    /** Store vector data.
+    /** Store the data of a member, serialized as a member network.
+     * @param id     Member id
      * @param output Serialized output
     **/
-    void store(Serializer::Output& output) const {
-        layer.store(output);
-    }
-public:
-    /** Print neuron weights to the given stream.
-     * @param ostr Output stream
-    **/
-    void print(::std::ostream& ostr) const {
-        layer.print(ostr);
+    void store(nat_t id, Serializer::Output& output) const {
+        for (nat_t j = 0; j < inter_dim; j++)
+            layer.neuron(id * inter_dim + j).store(output);
+        tails[id].store(output);
     }
 };
 
 }
 
 // ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
-// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Neural Network ▔
-// ▁ Learning discipline ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Ensemble ▔
+// ▁ Model store ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
 
+#if STATICNET_MMAP
 namespace StaticNet {
 
-/** Learning discipline.
- * @param input_dim  Input vector dimensions
- * @param output_dim Output vector dimensions
+/** Network published in a file shared by the processes of a host, and reloaded between requests when a new version is published.
+ * The file holds a header (magic number, format version, dimensions, checksum) followed by the parameters, in the order
+ * of 'store'. Versions are published by writing a new file then renaming it over the model path (see 'publish'), so a
+ * file once opened never changes. Each reader maps the file read-only and shared, checks its header, then computes
+ * straight from the mapping through a view of the network: the parameters stay the single page-cache copy of the host,
+ * while the activation functions (bound to the transfert function of the reader) are private to the view. The version
+ * in use is only ever replaced by 'refresh', which the owning thread calls between requests, hence no request sees a
+ * torn or half-updated network. The mapping of the version in use is kept, so its file is never reused under the
+ * reader. One store per reading thread (like the reader side of 'Snapshots').
+ * @param Net Network type
 **/
-template<nat_t input_dim, nat_t output_dim> class Learning final {
-    static_assert(input_dim > 0, "Invalid input vector dimension");
-    static_assert(output_dim > 0, "Invalid output vector dimension");
-private:
-    /** Input vector type.
-    **/
-    using Input  = Vector<input_dim>;
-    /** Output vector type.
+template<class Net> class ModelStore;
+template<class Policy, nat_t... dims> class ModelStore<BasicNetwork<Policy, dims...>> final {
+public:
+    /** Network and view types.
     **/
-    using Output = Vector<output_dim>;
-    /** Input, and expected output, with error margin.
+    using Net  = BasicNetwork<Policy, dims...>;
+    using View = typename Net::View;
+private:
+    constexpr static uint64_t magic  = 0x4c444f4d54534e53; // "SNSTMODL" in little-endian order, also telling the byte order
+    constexpr static uint32_t format = 1; // Format version
+    constexpr static size_t   count  = Net::size() / sizeof(val_t); // Number of parameters
+    /** File header, the parameters following right after.
     **/
-    class Constraint final {
-    private:
-        Input  input;    // Input vector
-        Output expected; // Expected output vector
-        Output margin;   // Tolerated margin
-    public:
-        /** Build a new constraint.
-         * @param input    Input vector
-         * @param expected Expected output vector
-         * @param margin   Tolerated margin vector
-        **/
-        Constraint(Input& input, Output& expected, Output& margin): input(input), expected(expected), margin(margin) {}
-    public:
-        /** Check equality between input vectors.
-         * @param input Input vector to compare with
-         * @return True if the stored input vector is equal to the given one, false otherwise
-        **/
-        bool match(Input& input) {
-            return this->input == input;
-        }
-        /** Correct the network one time, if needed.
-         * @param network Neural network to correct
-         * @param eta     Correction factor
-         * @param limit   Weight absolute value limit times input synapses (optional, <= 0 for none)
-         * @return True if on bounds, false if a correction has been applied
-        **/
-        template<nat_t... implicit_dims> bool correct(Network<implicit_dims...>& network, val_t eta, val_t limit = 0) {
-            Output output; // Output vector
-            network.compute(input, output);
-            for (nat_t i = 0; i < output_dim; i++) { // Check for bounds
-                val_t diff = expected.get(i) - output.get(i);
-                if ((diff < 0 ? -diff : diff) > margin.get(i)) { // Out of at least one bound
-                    network.correct(input, expected, output, eta, limit);
-                    return false;
-                }
-            }
-            return true;
-        }
+    class Header final {
     public:
-        /** Print constraint to the given stream.
-         * @param ostr Output stream
-        **/
-        void print(::std::ostream& ostr) {
-            ostr << "{ ";
-            input.print(ostr);
-            ostr << ", ";
-            expected.print(ostr);
-            ostr << ", ";
-            margin.print(ostr);
-            ostr << " }";
-        }
+        uint64_t magic;    // Magic number
+        uint32_t format;   // Format version
+        uint32_t value;    // Size of a parameter, in bytes
+        uint64_t shape;    // Hash of the dimensions
+        uint64_t count;    // Number of parameters
+        uint64_t checksum; // Hash of the parameters
+        uint32_t input;    // Input vector dimension
+        uint32_t output;   // Output vector dimension
+        uint8_t  padding[16]; // Zeroed, for the parameters to start on a cache line
     };
+    static_assert(sizeof(Header) == Allocator::cache_line, "Unexpected model file header size");
 private:
-    ::std::vector<Constraint> constraints; // Constraints set
-    ::std::random_device device; // Random device
-    ::std::default_random_engine engine; // Default engine
-public:
-    /** Build an empty learning discipline.
-    **/
-    Learning(): constraints(), device(), engine(device()) {}
-public:
-    /** Add a constraint to the discipline, not checked for duplicate.
-     * @param input  Input vector
-     * @param output Expected output vector
-     * @param margin Tolerated margin vector
+    ::std::string path; // Model file path
+    ::std::unique_ptr<MappedFile> mapping; // Mapping of the version in use (null for none)
+    View  view;   // View of the version in use
+    dev_t device; // Device of the version in use
+    ino_t inode;  // Inode of the version in use
+    nat_t loaded; // Number of versions loaded
+private:
+    /** Hash some bytes (64-bit FNV-1a).
+     * @param data Bytes to hash
+     * @param size Number of bytes
+     * @return Hash value
     **/
-    void add(Input& input, Output& output, Output& margin) {
-        constraints.emplace(constraints.end(), input, output, margin);
+    static uint64_t hash(void const* data, size_t size) {
+        uint8_t const* bytes = static_cast<uint8_t const*>(data);
+        uint64_t value = 0xcbf29ce484222325;
+        for (size_t i = 0; i < size; i++)
+            value = (value ^ bytes[i]) * 0x100000001b3;
+        return value;
     }
-    /** Tell if a constraint exists based on the input vector.
-     * @param input Input vector of the constraint to find
-     * @return True if a matching constraint has been found, false otherwise
+    /** Build the header expected for the network type, the checksum excepted.
+     * @return Expected header
     **/
-    bool has(Input& input) {
-        for (Constraint& constraint: constraints)
-            if (constraint.match(input))
-                return true;
-        return false;
+    static Header expected() {
+        uint64_t const shape[] = { static_cast<uint64_t>(dims)... };
+        nat_t const ends[] = { dims... };
+        Header header;
+        ::std::memset(&header, 0, sizeof(header));
+        header.magic  = magic;
+        header.format = format;
+        header.value  = sizeof(val_t);
+        header.shape  = hash(shape, sizeof(shape));
+        header.count  = count;
+        header.input  = static_cast<uint32_t>(ends[0]);
+        header.output = static_cast<uint32_t>(ends[sizeof...(dims) - 1]);
+        return header;
     }
-    /** Remove a constraint based on the input vector.
-     * @param input Input vector of the constraint to remove
+    /** Tell whether a file is the version in use.
+     * @param info Status of the file
+     * @return True if it is the version in use, false otherwise
     **/
-    void remove(Input& input) {
-        nat_t pos = 0;
-        for (Constraint& constraint: constraints) {
-            if (constraint.match(input)) {
-                constraints.erase(pos);
-                return;
-            }
-            pos++;
-        }
+    bool used(struct ::stat const& info) const {
+        return mapping && info.st_dev == device && info.st_ino == inode;
     }
-    /** Remove all constraints.
+    /** Tell whether a mapped file is a valid model for the network type.
+     * @param file Mapped file
+     * @return True if valid, false otherwise
     **/
-    void reset() {
-        constraints.clear();
+    static bool valid(MappedFile const& file) {
+        if (file.size() != sizeof(Header) + count * sizeof(val_t))
+            return false;
+        Header header;
+        ::std::memcpy(&header, file.data(), sizeof(header));
+        Header const reference = expected();
+        return header.magic == reference.magic && header.format == reference.format && header.value == reference.value && header.shape == reference.shape && header.count == reference.count && header.input == reference.input && header.output == reference.output && header.checksum == hash(file.data() + sizeof(Header), count * sizeof(val_t));
     }
 public:
-    /** Correct the network one time, so that each output is near enough from its expected output.
-     * @param network Neural network to correct
-     * @param eta     Correction factor
-     * @param limit   Weight absolute value limit times input synapses (optional, <= 0 for none)
-     * @return Number of out-bounds constraints
+    /** Load the current version.
+     * @param path  Model file path
+     * @param trans Transfert function of the view (ignored by table-free activation functions)
     **/
-    template<nat_t... implicit_dims> nat_t correct(Network<implicit_dims...>& network, val_t eta, val_t limit = 0) {
-        nat_t count = 0;
-        for (Constraint& constraint: constraints) {
-            if (!constraint.correct(network, eta, limit)) // Not in-bounds
-                count++;
-        }
-        return count;
+    ModelStore(char const* path, Transfert const& trans): path(path), mapping(), view(trans), device(0), inode(0), loaded(0) {
+        if (!refresh())
+            throw ::std::runtime_error("Unable to load a model from '" + this->path + "'");
     }
-    /** Randomize constraints order.
+    /** Copy constructor (deleted).
     **/
-    void shuffle() {
-        ::std::shuffle(constraints.begin(), constraints.end(), engine);
+    ModelStore(ModelStore const&) = delete;
+public:
+    /** Publish a version of a network, atomically replacing the model file.
+     * @param path    Model file path
+     * @param network Network to publish
+     * @return True on success, false otherwise
+    **/
+    static bool publish(char const* path, Net const& network) {
+        ::std::vector<uint8_t> image(sizeof(Header) + count * sizeof(val_t));
+        Serializer::MemoryOutput output(image.data() + sizeof(Header));
+        network.store(output);
+        Header header = expected();
+        header.checksum = hash(image.data() + sizeof(Header), count * sizeof(val_t));
+        ::std::memcpy(image.data(), &header, sizeof(header));
+        return replace(path, image.data(), image.size());
     }
 public:
-    /** Print learning discipline to the given stream.
-     * @param ostr Output stream
+    /** Switch to the latest published version, if it is new and valid; to be called between requests.
+     * A version that cannot be mapped, or whose header does not match the network type or its parameters, is ignored,
+     * the version in use being kept.
+     * @return True if a new version is now in use, false otherwise
     **/
-    void print(::std::ostream& ostr) {
-        if (constraints.empty()) {
-            ostr << "{}";
-            return;
-        }
-        ostr << "{" << ::std::endl << "\t";
-        bool first = true;
-        for (Constraint& constraint: constraints) {
-            if (first) {
-                first = false;
-                constraint.print(ostr);
-            } else {
-                ostr << "," << ::std::endl << "\t";
-                constraint.print(ostr);
-            }
+    bool refresh() {
+        struct ::stat info;
+        if (::stat(path.c_str(), &info) != 0 || used(info)) // Cheap check first
+            return false;
+        ::std::unique_ptr<MappedFile> latest;
+        try {
+            latest.reset(new MappedFile(path.c_str()));
+        } catch (::std::runtime_error const&) {
+            return false;
         }
-        ostr << ::std::endl << "}";
+        if (!latest->status(info) || used(info)) // Replaced again since
+            return false;
+        latest->prefetch(0, latest->size()); // Read ahead in one sequential pass
+        if (!valid(*latest))
+            return false;
+        view.attach(reinterpret_cast<val_t const*>(latest->data() + sizeof(Header)));
+        mapping.swap(latest);
+        device = info.st_dev;
+        inode  = info.st_ino;
+        ++loaded;
+        return true;
+    }
+    /** Get the version in use, valid until the next call to 'refresh'.
+     * @return View of the network in use
+    **/
+    View const& get() const {
+        return view;
+    }
+    /** Return the number of versions loaded so far.
+     * @return Number of versions loaded, the first one included
+    **/
+    nat_t version() const {
+        return loaded;
     }
 };
 
 }
+#endif
 
 // ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
-// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Learning discipline ▔
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Model store ▔
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
 #endif
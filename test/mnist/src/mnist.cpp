@@ -24,14 +24,19 @@
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
 
 // External headers
+#include <chrono>
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <memory>
+#include <sstream>
 #include <stdexcept>
 #include <type_traits>
 #include <unordered_map>
 extern "C" {
 #include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -60,7 +65,9 @@ val_t const value_valid    = 0.8; // Value for "valid dimension"
 val_t const value_invalid  = 0.2; // Value for "invalid dimension"
 val_t const margin_valid   = 0.2; // Margin for "valid dimension"
 val_t const margin_invalid = 0.3; // Margin for "invalid dimensions"
-val_t const eta = 0.01; // Learning rate
+val_t const margin_softmax = 0.5; // Margin for every dimension with a softmax output, i.e. the label has a probability >= 1/2
+val_t const eta = 0.01; // Default learning rate
+uint32_t const magic_ckpt = 0x4b434e53; // Checkpoint magic number
 
 /** Input vector.
 **/
@@ -70,9 +77,56 @@ using Input = Vector<input_dim>;
 **/
 using Output = Vector<output_dim>;
 
+/** Activation function of the hidden layer: the transfert function, as for the networks in 'net/', or table-free ReLU when built with 'RELU=1'.
+**/
+#ifdef MNIST_RELU
+using Hidden = Activation::Relu;
+#else
+using Hidden = Activation::Table;
+#endif
+
+/** Activation policy of the fully-connected networks, transfert function on the output layer.
+**/
+using Dense = Activation::Hidden<Hidden, Activation::Table>;
+
+#ifdef MNIST_CONV
+/** Activation policy when built with 'CONV=1': 4 kernels of 5x5 pixels, then 2x2 max-pooling, then the output layer.
+**/
+using Policy = Activation::List<ConvLayer<rows_length, cols_length, 1, 4, 5, Hidden>, PoolLayer<rows_length - 4, cols_length - 4, 4, 2>, Activation::Table>;
+
+/** Network used.
+**/
+using Net = BasicNetwork<Policy, rows_length * cols_length, (rows_length - 4) * (cols_length - 4) * 4, (rows_length - 4) * (cols_length - 4), output_dim>;
+
+/** Training pipeline used, one thread per layer.
+ * @param Out   Output stage
+ * @param Optim Optimizer type
+**/
+template<class Out, class Optim> using Pipe = Pipeline<Out, Optim, Policy, rows_length * cols_length, (rows_length - 4) * (cols_length - 4) * 4, (rows_length - 4) * (cols_length - 4), output_dim>;
+#else
+/** Activation policy.
+**/
+using Policy = Dense;
+
 /** Network used.
 **/
-using Net = Network<rows_length * cols_length, rows_length * cols_length / 8, output_dim>;
+using Net = BasicNetwork<Policy, rows_length * cols_length, rows_length * cols_length / 8, output_dim>;
+
+/** Compressed network used, after pruning.
+ * @param block Block size, in weights
+**/
+template<nat_t block> using SparseNet = SparseNetwork<Policy, block, rows_length * cols_length, rows_length * cols_length / 8, output_dim>;
+
+/** Training pipeline used, one thread per layer.
+ * @param Out   Output stage
+ * @param Optim Optimizer type
+**/
+template<class Out, class Optim> using Pipe = Pipeline<Out, Optim, Policy, rows_length * cols_length, rows_length * cols_length / 8, output_dim>;
+#endif
+
+/** Distilled network, with a narrower hidden layer.
+**/
+using Student = BasicNetwork<Dense, rows_length * cols_length, rows_length * cols_length / 32, output_dim>;
 
 // ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Constants ▔
@@ -99,18 +153,28 @@ constexpr nat_t label_to_dim(nat_t label) {
 
 // ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
 
+/** Convert a grey-scale to an input level.
+ * @param color Grey-scale to convert
+ * @param zero  Zero-background encoding
+ * @return Input level (-1 white ... +1 black, or 0 white ... +1 black with zero-background encoding)
+**/
+inline val_t color_to_level(nat_t color, bool zero) {
+    return zero ? static_cast<val_t>(color) / 255 : static_cast<val_t>(color) / 255 * 2 - 1;
+}
+
 /** Initialize an output, and optionaly a margin vector from a label.
- * @param label  Label to translate
- * @param output Output vector
- * @param margin Margin vector (optional)
+ * @param label   Label to translate
+ * @param output  Output vector
+ * @param margin  Margin vector (optional)
+ * @param softmax Whether the targets are the probabilities of a softmax output (optional)
 **/
-void label_to_vector(nat_t label, Output& output, Output* margin = null) {
+void label_to_vector(nat_t label, Output& output, Output* margin = null, bool softmax = false) {
     nat_t dim_label = label_to_dim(label);
     for (nat_t i = 0; i < output_dim; i++)
-        output.set(i, i == dim_label ? value_valid : value_invalid);
+        output.set(i, i == dim_label ? (softmax ? 1 : value_valid) : (softmax ? 0 : value_invalid));
     if (margin)
         for (nat_t i = 0; i < output_dim; i++)
-            margin->set(i, i == dim_label ? margin_valid : margin_invalid);
+            margin->set(i, softmax ? margin_softmax : (i == dim_label ? margin_valid : margin_invalid));
 }
 
 /** Translate an output vector to a label.
@@ -130,6 +194,46 @@ nat_t vector_to_label(Output& output) {
     return dim_to_label(largest_dim);
 }
 
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+/** List of 'name=value' options.
+**/
+using Options = ::std::vector<::std::string>;
+
+/** Get the value of an option.
+ * @param opts Options list
+ * @param name Option name
+ * @param def  Default value (optional)
+ * @return Option value, or the default value if not specified
+**/
+char const* option(Options const& opts, char const* name, char const* def = null) {
+    size_t length = ::std::strlen(name);
+    for (::std::string const& opt: opts)
+        if (opt.compare(0, length, name) == 0 && opt.size() > length && opt[length] == '=')
+            return opt.c_str() + length + 1;
+    return def;
+}
+
+/** Write a raw value to a stream.
+ * @param Type  Value type
+ * @param ostr  Output stream
+ * @param value Value to write
+**/
+template<class Type> void put(::std::ostream& ostr, Type value) {
+    ostr.write(reinterpret_cast<::std::remove_reference<decltype(ostr)>::type::char_type*>(&value), sizeof(Type));
+}
+
+/** Read a raw value from a stream.
+ * @param Type Value type
+ * @param istr Input stream
+ * @return Value read (undefined if the stream fails)
+**/
+template<class Type> Type get(::std::istream& istr) {
+    Type value = Type();
+    istr.read(reinterpret_cast<::std::remove_reference<decltype(istr)>::type::char_type*>(&value), sizeof(Type));
+    return value;
+}
+
 }
 
 // ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
@@ -203,21 +307,14 @@ private:
     class Entry final {
     private:
         uint8_t data[input_dim];
-    private:
-        /** Convert a grey-scale to an input level.
-         * @param color Grey-scale to convert
-         * @return Input level (-1 white ... +1 black)
-        **/
-        val_t convert(nat_t color) const {
-            return static_cast<val_t>(color) / 255 * 2 - 1;
-        }
     public:
         /** Initialize a vector with such data.
          * @param vector Vector to initialize
+         * @param zero   Zero-background encoding
         **/
-        void dump(Input& vector) const {
+        void dump(Input& vector, bool zero) const {
             for (nat_t i = 0; i < input_dim; i++)
-                vector.set(i, convert(data[i]));
+                vector.set(i, Helper::color_to_level(data[i], zero));
         }
     };
 private:
@@ -227,6 +324,7 @@ private:
     Map img; // File descriptor (-1 for none) for the images file
     Map lab; // File descriptor (-1 for none) for the labels file
     nat_t count;  // Remaining images
+    bool  zero;   // Zero-background encoding
 private:
     /** Inverse endianess.
      * @param UInt  Implicit unsigned integer type
@@ -245,8 +343,9 @@ public:
     /** Open images/labels files, basic validity checks.
      * @param path_img Images file to open
      * @param path_lab Labels file to open
+     * @param zero     Zero-background encoding, i.e. white pixels as 0 inputs (optional)
     **/
-    Loader(char const* path_img, char const* path_lab): img(path_img), lab(path_lab) {
+    Loader(char const* path_img, char const* path_lab, bool zero = false): img(path_img), lab(path_lab), zero(zero) {
         uint32_t (&header_img)[4] = *img.read<uint32_t[4]>(); // Magic number, image count, row size, column size
         uint32_t (&header_lab)[2] = *lab.read<uint32_t[2]>(); // Magic number, label count
         if (header_img[2] != endian_inverse<uint32_t>(rows_length) || header_img[3] != endian_inverse<uint32_t>(cols_length)) {
@@ -277,6 +376,12 @@ public:
         }
     }
 public:
+    /** Check the input encoding.
+     * @return True for the zero-background encoding
+    **/
+    bool zero_background() const {
+        return zero;
+    }
     /** Initialize an input vector and an associated label.
      * @param vector Input vector
      * @param label  Associated label
@@ -287,12 +392,302 @@ public:
             throw ::std::runtime_error("No more image to feed");
         Entry& image = *img.read<Entry>();
         uint8_t& lbl = *lab.read<uint8_t>();
-        image.dump(vector);
+        image.dump(vector, zero);
         label = static_cast<nat_t>(lbl);
         return --count != 0;
     }
 };
 
+/** Training samples read in place from memory-mapped files, for streamed training.
+**/
+class Dataset final: public Source<input_dim, output_dim> {
+private:
+    constexpr static size_t header_img = 16; // Images file header size, in bytes
+    constexpr static size_t header_lab = 8;  // Labels file header size, in bytes
+private:
+    MappedFile img; // Images file
+    MappedFile lab; // Labels file
+    nat_t count;   // Number of samples
+    bool  zero;    // Zero-background encoding
+    bool  softmax; // Whether the targets are the probabilities of a softmax output
+private:
+    /** Read a big-endian 32-bit unsigned integer.
+     * @param data Pointer to the integer
+     * @return Integer value
+    **/
+    static uint32_t big_endian(uint8_t const* data) {
+        return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+    }
+    /** Throw an error about the training files.
+     * @param path_img Images file
+     * @param path_lab Labels file
+     * @param what     Error description
+    **/
+    [[noreturn]] static void fail(char const* path_img, char const* path_lab, char const* what) {
+        ::std::string err_str;
+        err_str.append("'");
+        err_str.append(path_img);
+        err_str.append("' and '");
+        err_str.append(path_lab);
+        err_str.append("' ");
+        err_str.append(what);
+        throw ::std::runtime_error(err_str);
+    }
+public:
+    /** Map images/labels files, validity checks.
+     * @param path_img Images file to map
+     * @param path_lab Labels file to map
+     * @param zero     Zero-background encoding, i.e. white pixels as 0 inputs
+     * @param softmax  Whether the targets are the probabilities of a softmax output
+    **/
+    Dataset(char const* path_img, char const* path_lab, bool zero, bool softmax): img(path_img), lab(path_lab), count(0), zero(zero), softmax(softmax) {
+        if (img.size() < header_img || lab.size() < header_lab)
+            fail(path_img, path_lab, "truncated headers");
+        uint8_t const* hi = img.data();
+        uint8_t const* hl = lab.data();
+        if (big_endian(hi) != 0x00000803 || big_endian(hl) != 0x00000801)
+            fail(path_img, path_lab, "invalid magic numbers");
+        if (big_endian(hi + 8) != rows_length || big_endian(hi + 12) != cols_length)
+            fail(path_img, path_lab, "invalid dimensions");
+        if (big_endian(hi + 4) != big_endian(hl + 4))
+            fail(path_img, path_lab, "count mismatch");
+        count = static_cast<nat_t>(big_endian(hi + 4));
+        if (unlikely(count < 1))
+            fail(path_img, path_lab, "no image");
+        if (img.size() < header_img + count * input_dim || lab.size() < header_lab + count)
+            fail(path_img, path_lab, "truncated data");
+    }
+public:
+    /** Return the number of samples.
+     * @return Number of samples
+    **/
+    virtual nat_t size() const {
+        return count;
+    }
+    /** Read a sample.
+     * @param index    Sample index
+     * @param input    Input vector (output)
+     * @param expected Expected output vector (output)
+     * @param margin   Tolerated margin vector (output)
+    **/
+    virtual void read(nat_t index, Input& input, Output& expected, Output& margin) {
+        uint8_t const* pixels = img.data() + header_img + index * input_dim;
+        for (nat_t i = 0; i < input_dim; i++)
+            input.set(i, Helper::color_to_level(pixels[i], zero));
+        Helper::label_to_vector(static_cast<nat_t>(lab.data()[header_lab + index]), expected, &margin, softmax);
+    }
+    /** Read ahead a range of samples.
+     * @param first First sample index
+     * @param count Number of samples
+    **/
+    virtual void prefetch(nat_t first, nat_t count) {
+        img.prefetch(header_img + first * input_dim, count * input_dim);
+        lab.prefetch(header_lab + first, count);
+    }
+    /** Drop a range of samples from the page cache.
+     * @param first First sample index
+     * @param count Number of samples
+    **/
+    virtual void release(nat_t first, nat_t count) {
+        img.release(header_img + first * input_dim, count * input_dim);
+        lab.release(header_lab + first, count);
+    }
+};
+
+/** Training samples read from the standard input while training, as pairs of images and labels IDX files.
+ * A labels file may come before its images file, the images being then turned into samples as they are read; an
+ * images file coming first is buffered until its labels.
+**/
+class Feeder final {
+private:
+    /** Inbox type.
+    **/
+    using Box = Inbox<input_dim, output_dim, 1024>;
+private:
+    constexpr static uint32_t max_images = 1 << 16; // Images of an images file coming first (buffered, about 50 MiB)
+    constexpr static uint32_t max_labels = 1 << 24; // Labels of a labels file coming first
+private:
+    Allocated<Box, Allocator::HugePage> inbox; // Pending samples
+    ::std::atomic<bool> done; // Whether the reading thread is done, every sample read being pushed
+    ::std::atomic<bool> stop; // Whether to stop reading
+    ::std::atomic<bool> quit; // Whether to stop pushing as well
+    ::std::atomic<nat_t> fed; // Samples pushed so far
+    bool zero;    // Zero-background encoding
+    bool softmax; // Whether the targets are the probabilities of a softmax output
+    ::std::thread thread; // Reading thread
+private:
+    /** Read bytes from the standard input, polling for a stop request.
+     * @param data Bytes read (output)
+     * @param size Number of bytes to read
+     * @return True on success, false on end of input, error or stop request
+    **/
+    bool fill(void* data, size_t size) {
+        uint8_t* cursor = static_cast<uint8_t*>(data);
+        while (size > 0) {
+            if (stop.load(::std::memory_order_relaxed))
+                return false;
+            struct pollfd pfd = { 0, POLLIN, 0 };
+            int ready = ::poll(&pfd, 1, 100);
+            if (ready < 0 && errno != EINTR)
+                return false;
+            if (ready <= 0)
+                continue;
+            ssize_t got = ::read(0, cursor, size);
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got <= 0)
+                return false;
+            cursor += got;
+            size -= static_cast<size_t>(got);
+        }
+        return true;
+    }
+    /** Read a big-endian 32-bit unsigned integer from the standard input.
+     * @param value Integer read (output)
+     * @return True on success, false otherwise
+    **/
+    bool read(uint32_t& value) {
+        uint8_t data[4];
+        if (!fill(data, sizeof(data)))
+            return false;
+        value = (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+        return true;
+    }
+    /** Read the rest of an images file header, the magic number being read.
+     * @param count Number of images (output)
+     * @return True if the images have the expected size, false otherwise
+    **/
+    bool images(uint32_t& count) {
+        uint32_t rows, cols;
+        return read(count) && read(rows) && read(cols) && rows == rows_length && cols == cols_length;
+    }
+    /** Push a sample, waiting for the trainer to merge.
+     * @param pixels Image pixels
+     * @param label  Image label
+     * @param sample Sample buffer
+     * @return True on success, false if asked to quit
+    **/
+    bool push(uint8_t const* pixels, uint8_t label, Box::Sample& sample) {
+        for (nat_t j = 0; j < input_dim; j++)
+            sample.input.set(j, Helper::color_to_level(pixels[j], zero));
+        Helper::label_to_vector(static_cast<nat_t>(label), sample.expected, &sample.margin, softmax);
+        while (!inbox->push(sample)) { // Wait for the trainer to merge
+            if (quit.load(::std::memory_order_relaxed))
+                return false;
+            ::std::this_thread::sleep_for(::std::chrono::milliseconds(1));
+        }
+        fed.fetch_add(1, ::std::memory_order_relaxed);
+        return true;
+    }
+    /** Read pairs of images and labels files until the end of the input, a malformed file or a stop request.
+    **/
+    void run() {
+        ::std::vector<uint8_t> buffer; // Images and labels, or labels only, of the current pair
+        uint8_t pixels[input_dim];     // Image being read, when streamed
+        Box::Sample sample;
+        while (true) {
+            uint32_t magic; // Magic number of the first file of the pair
+            uint32_t count; // Number of images and labels
+            uint32_t other; // Number of elements of the second file
+            if (!read(magic)) // End of input, or stopped
+                break;
+            bool valid = false;
+            if (magic == 0x00000803) { // Images first, buffered until their labels
+                valid = images(count) && count <= max_images;
+                if (valid) {
+                    buffer.resize(static_cast<size_t>(count) * (input_dim + 1)); // Images, then labels
+                    uint8_t* labels = buffer.data() + static_cast<size_t>(count) * input_dim;
+                    valid = fill(buffer.data(), static_cast<size_t>(count) * input_dim) && read(magic) && magic == 0x00000801 && read(other) && other == count && fill(labels, count);
+                    for (nat_t i = 0; valid && i < count; i++) {
+                        if (!push(buffer.data() + i * input_dim, labels[i], sample))
+                            return;
+                    }
+                }
+            } else if (magic == 0x00000801) { // Labels first, the images being pushed as they are read
+                valid = read(count) && count <= max_labels;
+                if (valid) {
+                    buffer.resize(count);
+                    valid = fill(buffer.data(), count) && read(magic) && magic == 0x00000803 && images(other) && other == count;
+                    for (nat_t i = 0; valid && i < count; i++) {
+                        valid = fill(pixels, input_dim);
+                        if (valid && !push(pixels, buffer[i], sample))
+                            return;
+                    }
+                }
+            }
+            if (!valid) {
+                if (!stop.load(::std::memory_order_relaxed))
+                    ::std::cerr << "Invalid or oversized images/labels file on the standard input" << ::std::endl;
+                break;
+            }
+        }
+        done.store(true, ::std::memory_order_release);
+    }
+public:
+    /** Start reading the standard input.
+     * @param zero    Zero-background encoding, i.e. white pixels as 0 inputs
+     * @param softmax Whether the targets are the probabilities of a softmax output
+    **/
+    Feeder(bool zero, bool softmax): inbox(), done(false), stop(false), quit(false), fed(0), zero(zero), softmax(softmax), thread([this]() { run(); }) {}
+    /** Copy constructor (deleted).
+    **/
+    Feeder(Feeder const&) = delete;
+    /** Stop reading the standard input, the samples not merged yet being dropped.
+    **/
+    ~Feeder() {
+        stop.store(true, ::std::memory_order_relaxed);
+        quit.store(true, ::std::memory_order_relaxed);
+        thread.join();
+    }
+public:
+    /** Get the inbox of the pending samples, to be merged by the trainer as it goes.
+     * @return Inbox, consumer side
+    **/
+    Box& pending() {
+        return *inbox;
+    }
+    /** Merge the pending samples into a learning discipline.
+     * @param discipline Learning discipline to merge into
+     * @return Number of samples merged
+    **/
+    template<class Discipline> nat_t merge(Discipline& discipline) {
+        return discipline.merge(*inbox);
+    }
+    /** Wait for new samples, and merge them into a learning discipline.
+     * @param discipline Learning discipline to merge into
+     * @return True if samples were merged, false if the standard input is exhausted
+    **/
+    template<class Discipline> bool wait(Discipline& discipline) {
+        while (true) {
+            bool last = done.load(::std::memory_order_acquire); // Read before merging, not to miss the last samples
+            if (merge(discipline) > 0)
+                return true;
+            if (last)
+                return false;
+            ::std::this_thread::sleep_for(::std::chrono::milliseconds(1));
+        }
+    }
+    /** Stop reading the standard input, then merge every sample already read into a learning discipline.
+     * @param discipline Learning discipline to merge into
+     * @return Number of samples merged
+    **/
+    template<class Discipline> nat_t close(Discipline& discipline) {
+        stop.store(true, ::std::memory_order_relaxed);
+        nat_t count = 0;
+        while (!done.load(::std::memory_order_acquire)) { // The samples of a file already read are still pushed
+            count += merge(discipline);
+            ::std::this_thread::sleep_for(::std::chrono::milliseconds(1));
+        }
+        return count + merge(discipline);
+    }
+    /** Return the number of samples read so far.
+     * @return Number of samples
+    **/
+    nat_t count() const {
+        return fed.load(::std::memory_order_relaxed);
+    }
+};
+
 /** Tests set.
 **/
 class Tests final {
@@ -306,17 +701,21 @@ private:
         class PGM final: public Serializer::Output {
         private:
             ::std::ofstream& file; // Output file
+            bool zero; // Zero-background encoding
         public:
             /** File initializer.
              * @param file File stream to initialize with
+             * @param zero Zero-background encoding
             **/
-            PGM(::std::ofstream& file): file(file) {}
+            PGM(::std::ofstream& file, bool zero): file(file), zero(zero) {}
         public:
             /** Store a pixel to the file.
-             * @param level Color level (-1 white ... +1 black)
+             * @param level Color level (-1 white ... +1 black, or 0 white ... +1 black with zero-background encoding)
             **/
             virtual void store(val_t value) {
                 uint8_t pixel;
+                if (zero)
+                    value = value * val_t(2) - val_t(1);
                 value = val_t(255) - (value + val_t(1)) * val_t(128);
                 if (value < 1) {
                     pixel = 0;
@@ -333,32 +732,37 @@ private:
         nat_t label; // Number represented
     public:
         /** Check if the network answered correctly.
+         * @param Out     Output stage
          * @param network Network to test
+         * @param guess   Label guessed (output)
          * @return True on a correct answer, false otherwise
         **/
-        template<nat_t... implicit_dims> bool check(Network<implicit_dims...>& network, nat_t& guess) const {
+        template<class Out, class Model> bool check(Model const& network, nat_t& guess) const {
             Output result;
-            network.compute(image, result);
+            network.template compute<Out>(image, result);
             guess = Helper::vector_to_label(result);
             return guess == label;
         }
         /** Output the picture to the given file, overwrite the file.
          * @param filename File to write
+         * @param zero     Zero-background encoding
         **/
-        void output(::std::string& filename) const {
+        void output(::std::string& filename, bool zero) const {
             ::std::ofstream file(filename);
             file << "P5\n28 28 255\n";
-            PGM serializer(file);
+            PGM serializer(file, zero);
             image.store(serializer);
         }
     };
 private:
     ::std::vector<Image> tests; // List of test images with labels
+    bool zero; // Zero-background encoding of the images
 public:
     /** Load images and labels from loader object.
      * @param loader Loader object to load from
     **/
     void load(Loader& loader) {
+        zero = loader.zero_background();
         while (true) { // At least one element in loader
             tests.emplace(tests.end());
             Image& current = tests.back(); // Current picture
@@ -367,30 +771,102 @@ public:
         }
     }
     /** Test network on the testing set.
+     * @param Out      Output stage
      * @param network  Network to test
      * @param errordir Directory to which failed test image are output (optional, null for no output)
      * @return Number of success, number of test elements
     **/
-    template<nat_t... implicit_dims> ::std::tuple<nat_t, nat_t> test(Network<implicit_dims...>& network, char const* const errordir = null) const {
+    template<class Out = Stage::Quadratic, class Model> ::std::tuple<nat_t, nat_t> test(Model const& network, char const* const errordir = null) const {
         nat_t count = 0; // Success counter
         nat_t error = 0; // Error counter
         for (Image const& test: tests) {
             nat_t guess;
-            if (test.check(network, guess)) {
+            if (test.template check<Out>(network, guess)) {
                 count++;
             } else if (errordir) {
                 ::std::string filename = ::std::string(errordir) + "/" + ::std::to_string(error++) + "_guessed_" + ::std::to_string(guess) + "_for_" + ::std::to_string(test.label) + ".pgm";
-                test.output(filename);
+                test.output(filename, zero);
             }
         }
         return ::std::make_tuple(count, static_cast<nat_t>(tests.size()));
     }
+    /** Test network on a random subset of the testing set, drawn with replacement.
+     * @param Out     Output stage
+     * @param network Network to test
+     * @param count   Number of test elements to draw
+     * @param engine  Random engine to draw with
+     * @return Number of success
+    **/
+    template<class Out, class Model> nat_t sample(Model const& network, nat_t count, ::std::default_random_engine& engine) const {
+        ::std::uniform_int_distribution<nat_t> draw(0, static_cast<nat_t>(tests.size()) - 1);
+        nat_t success = 0;
+        for (nat_t i = 0; i < count; i++) {
+            nat_t guess;
+            if (tests[draw(engine)].template check<Out>(network, guess))
+                success++;
+        }
+        return success;
+    }
+    /** Return the number of test elements.
+     * @return Number of test elements
+    **/
+    nat_t size() const {
+        return static_cast<nat_t>(tests.size());
+    }
+    /** Calibrate the threshold of a cascade, as the lowest one for which the cascade is at most as wrong as its full network.
+     * @param Out       Output stage
+     * @param cascade   Cascade to calibrate (its threshold is set)
+     * @param tolerance Tolerated accuracy loss, in ratio of the test elements (optional)
+     * @return Calibrated threshold
+    **/
+    template<class Out, class Cheap, class Full> val_t calibrate(Cascade<Cheap, Full>& cascade, val_t tolerance = 0) const {
+        ::std::vector<::std::tuple<val_t, bool, bool>> gaps; // Gap, cheap and full answers correctness of each test image
+        nat_t full = 0; // Full network successes
+        for (Image const& test: tests) {
+            Output result;
+            cascade.first().template compute<Out>(test.image, result);
+            val_t gap = Cascade<Cheap, Full>::gap(result);
+            bool cheap_ok = Helper::vector_to_label(result) == test.label;
+            nat_t guess;
+            bool full_ok = test.template check<Out>(cascade.second(), guess);
+            gaps.emplace_back(gap, cheap_ok, full_ok);
+            if (full_ok)
+                full++;
+        }
+        ::std::sort(gaps.begin(), gaps.end(), [](::std::tuple<val_t, bool, bool> const& a, ::std::tuple<val_t, bool, bool> const& b) {
+            return ::std::get<0>(a) < ::std::get<0>(b);
+        });
+        val_t target = static_cast<val_t>(full) - tolerance * static_cast<val_t>(gaps.size()); // Successes to reach
+        nat_t count = 0; // Successes when escalating the 'k' lowest gaps
+        for (auto const& entry: gaps)
+            count += ::std::get<1>(entry) ? 1 : 0;
+        val_t threshold = ::std::numeric_limits<val_t>::infinity(); // Always escalate by default
+        for (nat_t k = 0; k <= gaps.size(); k++) {
+            if (k == gaps.size() || k == 0 || ::std::get<0>(gaps[k - 1]) < ::std::get<0>(gaps[k])) { // Threshold possible between two distinct gaps
+                if (count >= target) {
+                    threshold = (k < gaps.size() ? ::std::get<0>(gaps[k]) : threshold);
+                    break;
+                }
+            }
+            if (k < gaps.size()) // Escalate the next image
+                count += (::std::get<2>(gaps[k]) ? 1 : 0) - (::std::get<1>(gaps[k]) ? 1 : 0);
+        }
+        cascade.set(threshold);
+        return threshold;
+    }
 };
 
 // ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
 
-// Learning discipline used to train networks
-Learning<input_dim, output_dim> discipline;
+// Learning discipline used to train networks, constraints on huge pages
+Learning<input_dim, output_dim, Allocator::HugePage> discipline;
+
+// Streamed training samples and discipline, when the training set is not loaded in memory (null otherwise)
+::std::unique_ptr<Dataset> dataset;
+::std::unique_ptr<Streaming<input_dim, output_dim, Allocator::HugePage>> streaming;
+
+// Samples read from the standard input while training (null for none)
+::std::unique_ptr<Feeder> feeder;
 
 // Tests set
 Tests tests;
@@ -409,39 +885,334 @@ static bool init_transfert() {
     return true;
 }
 
-// Network to use
-Net network(transfert);
+// Network to use, on huge pages
+Allocated<Net, Allocator::HugePage> network(transfert);
+
+// Distilled network, on huge pages
+Allocated<Student, Allocator::HugePage> student(transfert);
 
 // ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Database ▔
 // ▁ Orders ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
 
-/** Learning order handler.
- * @param argc Number of arguments
- * @param argv Arguments (at least 2)
+/** Print the hardware counters report, if asked.
+ * @param opts Order options
+**/
+static void profile(Helper::Options const& opts) {
+    if (::std::string(Helper::option(opts, "profile", "0")) != "1")
+        return;
+#ifdef STATICNET_PROFILE
+    Profiling::Registry::instance().dump(::std::cerr);
+#else
+    ::std::cerr << "Profiling not compiled in (build with PROFILE=<regions mask>)" << ::std::endl;
+#endif
+}
+
+/** Write a checkpoint snapshot of the training state.
+ * @param buffer Snapshot buffer (output)
+ * @param opts   Training options
+ * @param step   Epochs done
+ * @param optim  Optimizer used
+**/
+template<class Optim> static void snapshot(::std::string& buffer, Helper::Options const& opts, nat_t step, Optim const& optim) {
+    ::std::ostringstream ostr;
+    Helper::put<uint32_t>(ostr, magic_ckpt);
+    Helper::put<uint32_t>(ostr, static_cast<uint32_t>(opts.size()));
+    for (::std::string const& opt: opts) {
+        Helper::put<uint32_t>(ostr, static_cast<uint32_t>(opt.size()));
+        ostr.write(opt.data(), opt.size());
+    }
+    Helper::put<uint32_t>(ostr, static_cast<uint32_t>(step));
+    Serializer::StreamOutput so(ostr);
+    network->store(so);
+    optim.store(so);
+    if (streaming) {
+        streaming->save(ostr);
+    } else {
+        discipline.save(ostr);
+    }
+    buffer = ostr.str();
+}
+
+/** Validation thread, testing snapshots of the network while it is trained.
+ * @param Out Output stage
+**/
+template<class Out> class Validator final {
+private:
+    Snapshots<Net, Allocator::HugePage> snapshots; // Network snapshots
+    nat_t subset; // Test elements drawn per validation (0 for the whole testing set)
+    ::std::atomic<bool> stop; // Whether to stop once the last snapshot is validated
+    ::std::thread thread; // Validation thread
+private:
+    /** Validate each new snapshot until stopped.
+    **/
+    void run() {
+        ::std::default_random_engine engine;
+        while (true) {
+            bool last = stop.load(::std::memory_order_acquire); // Read before acquiring, not to miss the last snapshot
+            Net const* copy = snapshots.acquire();
+            if (!copy) {
+                if (last)
+                    return;
+                ::std::this_thread::sleep_for(::std::chrono::milliseconds(10));
+                continue;
+            }
+            nat_t success;
+            nat_t total;
+            if (subset > 0) {
+                success = tests.sample<Out>(*copy, subset, engine);
+                total   = subset;
+            } else {
+                ::std::tie(success, total) = tests.test<Out>(*copy);
+            }
+            ::std::cerr << "\rValidation... epoch " << snapshots.tag() << ": " << success << "/" << total << " (" << 100. * success / total << " %)          " << ::std::endl;
+        }
+    }
+public:
+    /** Start the validation thread.
+     * @param master Network to validate
+     * @param subset Test elements drawn per validation (0 for the whole testing set)
+    **/
+    Validator(Net const& master, nat_t subset): snapshots(master), subset(subset), stop(false), thread([this]() { run(); }) {}
+    /** Copy constructor (deleted).
+    **/
+    Validator(Validator const&) = delete;
+    /** Validate the last snapshot, then stop the validation thread.
+    **/
+    ~Validator() {
+        stop.store(true, ::std::memory_order_release);
+        thread.join();
+    }
+public:
+    /** Publish a snapshot of the network, never waits for the validation.
+     * @param network Network to validate
+     * @param epoch   Epochs done
+    **/
+    void publish(Net const& network, nat_t epoch) {
+        snapshots.publish(network, epoch);
+    }
+};
+
+/** Epochs runner, through a pipeline if asked and allowed by the optimizer.
+ * @param Out   Output stage
+ * @param Optim Optimizer type
+**/
+template<class Out, class Optim, bool = Optim::concurrent> class Trainer final {
+private:
+    Optim& optim; // Optimizer to use
+    val_t  limit; // Weight absolute value limit times input synapses
+    Allocated<Net::Space> workspace; // Intermediate vectors, for every epoch
+    ::std::unique_ptr<Allocated<Pipe<Out, Optim>>> pipeline; // Training pipeline (null for none)
+public:
+    /** Constructor.
+     * @param optim     Optimizer to use
+     * @param limit     Weight absolute value limit times input synapses (<= 0 for none)
+     * @param pipelined Whether to train through a pipeline
+    **/
+    Trainer(Optim& optim, val_t limit, bool pipelined): optim(optim), limit(limit), workspace(), pipeline(pipelined ? new Allocated<Pipe<Out, Optim>>(*network, optim, limit) : null) {}
+public:
+    /** Run one epoch, the network being left untouched on return.
+     * @param first First constraint to correct (optional)
+     * @return Number of out-bounds constraints
+    **/
+    nat_t run(nat_t first = 0) {
+        if (streaming)
+            return streaming->template correct<Out>(*network, *workspace, optim, limit);
+        if (pipeline)
+            return feeder ? discipline.correct(**pipeline, feeder->pending(), first) : discipline.correct(**pipeline);
+        if (feeder) // New samples merged as they come
+            return discipline.correct<Out>(*network, *workspace, feeder->pending(), optim, limit, first);
+        return discipline.correct<Out>(*network, *workspace, optim, limit);
+    }
+};
+template<class Out, class Optim> class Trainer<Out, Optim, false> final {
+private:
+    Optim& optim; // Optimizer to use
+    val_t  limit; // Weight absolute value limit times input synapses
+    Allocated<Net::Space> workspace; // Intermediate vectors, for every epoch
+public:
+    /** Constructor, the optimizer does not allow pipelining.
+     * @param optim Optimizer to use
+     * @param limit Weight absolute value limit times input synapses (<= 0 for none)
+    **/
+    Trainer(Optim& optim, val_t limit, bool): optim(optim), limit(limit), workspace() {}
+public:
+    /** Run one epoch.
+     * @param first First constraint to correct (optional)
+     * @return Number of out-bounds constraints
+    **/
+    nat_t run(nat_t first = 0) {
+        if (streaming)
+            return streaming->template correct<Out>(*network, *workspace, optim, limit);
+        if (feeder) // New samples merged as they come
+            return discipline.correct<Out>(*network, *workspace, feeder->pending(), optim, limit, first);
+        return discipline.correct<Out>(*network, *workspace, optim, limit);
+    }
+};
+
+/** Learning phase, until every constraint is in bounds.
+ * @param Out    Output stage
+ * @param optim  Optimizer to use
+ * @param limit  Weight absolute value limit times input synapses (<= 0 for none)
+ * @param step   Epochs already done
+ * @param opts   Training options
+ * @param resume Checkpoint stream to resume from, positioned on the network (null for none)
+ * @return True on success, false otherwise
+**/
+template<class Out, class Optim> static bool learn(Optim& optim, val_t limit, nat_t step, Helper::Options const& opts, ::std::istream* resume) {
+    if (resume) { // Optimizer and discipline states
+        Serializer::StreamInput si(*resume);
+        try {
+            optim.load(si);
+        } catch (::std::runtime_error& err) {
+            ::std::cerr << "Invalid checkpoint: " << err.what() << ::std::endl;
+            return false;
+        }
+        if (!(streaming ? streaming->restore(*resume) : discipline.restore(*resume))) {
+            ::std::cerr << "Invalid checkpoint for these training files" << ::std::endl;
+            return false;
+        }
+    }
+    char const* path = Helper::option(opts, "checkpoint");
+    nat_t every = static_cast<nat_t>(::std::atol(Helper::option(opts, "every", "10")));
+    nat_t epochs = static_cast<nat_t>(::std::atol(Helper::option(opts, "epochs", "0")));
+    ::std::unique_ptr<Checkpointer> checkpointer(path ? new Checkpointer(path) : null);
+    ::std::string buffer; // Snapshot buffer
+    Trainer<Out, Optim> trainer(optim, limit, ::std::string(Helper::option(opts, "pipeline", "0")) == "1");
+    nat_t interval = ::std::max<nat_t>(static_cast<nat_t>(::std::atol(Helper::option(opts, "interval", "1"))), 1);
+    ::std::unique_ptr<Validator<Out>> validator(tests.size() > 0 ? new Validator<Out>(*network, static_cast<nat_t>(::std::atol(Helper::option(opts, "subset", "0")))) : null);
+    ::std::cerr << "Learning phase... epoch " << step << ": ...";
+    ::std::cerr.flush();
+    auto start = ::std::chrono::steady_clock::now();
+    while (true) {
+        optim.epoch(step);
+        nat_t count = trainer.run();
+        ::std::cerr << "\rLearning phase... epoch " << ++step << ": " << count << "          ";
+        if (validator && step % interval == 0) // Hand a snapshot over to the validator
+            validator->publish(*network, step);
+        if (epochs > 0 && step >= epochs) {
+            nat_t first = discipline.size();
+            if (feeder && feeder->close(discipline) > 0) // Samples read during the last epoch but not merged, corrected once
+                trainer.run(first);
+            break;
+        }
+        if (count == 0 && (!feeder || !feeder->wait(discipline))) // Every constraint in bounds, and no more to come
+            break;
+        ::std::cerr.flush();
+        if (!streaming)
+            discipline.shuffle();
+        if (checkpointer && every > 0 && step % every == 0) { // Hand a snapshot over to the writer
+            snapshot(buffer, opts, step, optim);
+            checkpointer->submit(buffer);
+        }
+    }
+    ::std::chrono::duration<double> elapsed = ::std::chrono::steady_clock::now() - start;
+    ::std::cerr << "\rLearning phase... epoch " << step << " done in " << elapsed.count() << " s.          " << ::std::endl;
+    if (validator && step % interval != 0) // Final network
+        validator->publish(*network, step);
+    validator.reset();
+    if (checkpointer && !checkpointer->good())
+        ::std::cerr << "Some checkpoints could not be written to '" << path << "'" << ::std::endl;
+    if (feeder)
+        ::std::cerr << "Online phase... " << feeder->count() << " samples read" << ::std::endl;
+    return true;
+}
+
+/** Learning phase, keeping the pruned weights at zero if asked.
+ * @param Out    Output stage
+ * @param optim  Optimizer to use
+ * @param limit  Weight absolute value limit times input synapses (<= 0 for none)
+ * @param step   Epochs already done
+ * @param opts   Training options
+ * @param resume Checkpoint stream to resume from, positioned on the network (null for none)
+ * @return True on success, false otherwise
+**/
+template<class Out, class Optim> static bool fit(Optim& optim, val_t limit, nat_t step, Helper::Options const& opts, ::std::istream* resume) {
+    if (::std::string(Helper::option(opts, "mask", "0")) == "1") {
+        Optimizer::Masked<Net, Optim, Allocator::HugePage> masked(*network, optim);
+        return learn<Out>(masked, limit, step, opts, resume);
+    }
+    return learn<Out>(optim, limit, step, opts, resume);
+}
+
+/** Training session, from scratch or from a checkpoint.
+ * @param Out      Output stage
+ * @param path_img Training images file
+ * @param path_lab Training labels file
+ * @param opts     Training options
+ * @param step     Epochs already done
+ * @param resume   Checkpoint stream to resume from, positioned on the network (null for none)
  * @return Return code
 **/
-int train(int argc, char** argv) {
-    if (argc < 4 || argc > 5) { // Wrong number of parameters
-        ::std::cerr << "Usage: " << argv[0] << " " << argv[1] << " <training images> <training labels> [limit] | 'raw trained network'" << ::std::endl;
-        return 0;
+template<class Out> static int session(char const* path_img, char const* path_lab, Helper::Options const& opts, nat_t step, ::std::istream* resume) {
+    val_t limit = static_cast<val_t>(::std::atof(Helper::option(opts, "limit", "0")));
+    ::std::string optimizer = Helper::option(opts, "optimizer", "plain");
+    Schedule schedule(eta);
+    { // Learning rate schedule
+        val_t  rate   = static_cast<val_t>(::std::atof(Helper::option(opts, "eta", "0.01")));
+        nat_t  period = static_cast<nat_t>(::std::atol(Helper::option(opts, "period", "100")));
+        val_t  factor = static_cast<val_t>(::std::atof(Helper::option(opts, "factor", "0.5")));
+        ::std::string shape = Helper::option(opts, "schedule", "constant");
+        if (shape == "constant") {
+            schedule = Schedule(rate);
+        } else if (shape == "step") {
+            schedule = Schedule::step(rate, factor, period);
+        } else if (shape == "cosine") {
+            schedule = Schedule::cosine(rate, rate / 100, period);
+        } else {
+            ::std::cerr << "Unknown schedule '" << shape << "'" << ::std::endl;
+            return 1;
+        }
+    }
+    if (optimizer != "plain" && optimizer != "momentum" && optimizer != "nesterov" && optimizer != "adam" && optimizer != "adamw") {
+        ::std::cerr << "Unknown optimizer '" << optimizer << "'" << ::std::endl;
+        return 1;
+    }
+    if (::std::string(Helper::option(opts, "pipeline", "0")) == "1" && (optimizer == "adam" || optimizer == "adamw")) {
+        ::std::cerr << "Optimizer '" << optimizer << "' cannot be pipelined" << ::std::endl;
+        return 1;
+    }
+    ::std::string encoding = Helper::option(opts, "input", "symmetric");
+    if (encoding != "symmetric" && encoding != "zero") {
+        ::std::cerr << "Unknown input encoding '" << encoding << "'" << ::std::endl;
+        return 1;
+    }
+    nat_t chunk = static_cast<nat_t>(::std::atol(Helper::option(opts, "stream", "0")));
+    if (chunk > 0 && ::std::string(Helper::option(opts, "pipeline", "0")) == "1") {
+        ::std::cerr << "Streamed training cannot be pipelined" << ::std::endl;
+        return 1;
+    }
+    bool online = ::std::string(Helper::option(opts, "online", "0")) == "1";
+    if (online && (chunk > 0 || resume || Helper::option(opts, "checkpoint"))) {
+        ::std::cerr << "Online training is neither streamed nor checkpointed" << ::std::endl;
+        return 1;
     }
-    val_t limit = (argc == 5 ? static_cast<val_t>(::std::atof(argv[4])) : 0);
     if (!init_transfert()) // Initialize transfert function
         return 1;
-    { // Loading phase
+    if (chunk > 0) { // Mapping phase, samples read during the epochs
+        ::std::cerr << "Mapping training files...";
+        ::std::cerr.flush();
+        try {
+            dataset.reset(new Dataset(path_img, path_lab, encoding == "zero", !Out::transfert));
+        } catch (::std::runtime_error& err) {
+            ::std::cerr << " fail: " << err.what() << ::std::endl;
+            return 1;
+        }
+        streaming.reset(new Streaming<input_dim, output_dim, Allocator::HugePage>(*dataset, chunk, static_cast<nat_t>(::std::atol(Helper::option(opts, "buffer", "0")))));
+        ::std::cerr << " done." << ::std::endl;
+    } else { // Loading phase
         ::std::cerr << "Loading training files...";
         ::std::cerr.flush();
         try {
-            Loader train(argv[2], argv[3]);
+            Loader train(path_img, path_lab, encoding == "zero");
             Input input;
             nat_t label;
             while (true) {
                 bool cont = train.feed(input, label); // There is at least one element to feed
                 Output output;
                 Output margin;
-                Helper::label_to_vector(label, output, &margin);
+                Helper::label_to_vector(label, output, &margin, !Out::transfert);
                 discipline.add(input, output, margin);
                 if (!cont)
                     break;
@@ -452,48 +1223,614 @@ int train(int argc, char** argv) {
         }
         ::std::cerr << " done." << ::std::endl;
     }
-    { // Randomize network
+    char const* valid_img = Helper::option(opts, "validate");
+    if (valid_img) { // Validation phase
+        ::std::cerr << "Loading validation files...";
+        ::std::cerr.flush();
+        try {
+            Loader valid(valid_img, Helper::option(opts, "validate-labels", ""), encoding == "zero");
+            tests.load(valid);
+        } catch (::std::runtime_error& err) {
+            ::std::cerr << " fail: " << err.what() << ::std::endl;
+            return 1;
+        }
+        ::std::cerr << " done." << ::std::endl;
+    }
+    if (online) // Samples read from now on
+        feeder.reset(new Feeder(encoding == "zero", !Out::transfert));
+    char const* init = Helper::option(opts, "init");
+    char const* seed = Helper::option(opts, "seed");
+    if (seed && !resume) { // Reproducible constraint order, a checkpoint restoring its own
+        discipline.seed(::std::strtoull(seed, null, 10));
+        if (streaming)
+            streaming->seed(::std::strtoull(seed, null, 10));
+    }
+    if (resume) { // Checkpointed network
+        Serializer::StreamInput si(*resume);
+        network->load(si);
+    } else if (init) { // Given network
+        ::std::ifstream file(init, ::std::ios::binary);
+        if (!file) {
+            ::std::cerr << "Unable to open '" << init << "' for reading" << ::std::endl;
+            return 1;
+        }
+        Serializer::StreamInput si(file);
+        network->load(si);
+    } else if (seed) { // Randomize network, reproducibly
+        PhiloxRandomizer<std::ratio<1, 100>> randomizer(::std::strtoull(seed, null, 10));
+        network->randomize(randomizer);
+    } else {
         UniformRandomizer<std::ratio<1, 100>> randomizer;
-        network.randomize(randomizer);
+        network->randomize(randomizer);
+    }
+    bool success;
+    if (optimizer == "momentum") { // Learning phase
+        Optimizer::Momentum<Net, Allocator::HugePage> optim(*network, schedule);
+        success = fit<Out>(optim, limit, step, opts, resume);
+    } else if (optimizer == "nesterov") {
+        Optimizer::Nesterov<Net, Allocator::HugePage> optim(*network, schedule);
+        success = fit<Out>(optim, limit, step, opts, resume);
+    } else if (optimizer == "adam" || optimizer == "adamw") {
+        Optimizer::Adam<Net, Allocator::HugePage> optim(*network, schedule, (optimizer == "adamw" ? val_t(0.01) : val_t(0)));
+        success = fit<Out>(optim, limit, step, opts, resume);
+    } else {
+        Optimizer::Plain optim(schedule);
+        success = fit<Out>(optim, limit, step, opts, resume);
+    }
+    if (!success)
+        return 1;
+    profile(opts);
+    { // Output phase
+        Serializer::StreamOutput so(::std::cout);
+        network->store(so);
+    }
+    char const* path = Helper::option(opts, "publish");
+    if (path && !ModelStore<Net>::publish(path, *network)) { // Atomic replacement, picked up by the serving processes
+        ::std::cerr << "Unable to publish the network to '" << path << "'" << ::std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/** Training session, dispatch on the output stage.
+ * @param path_img Training images file
+ * @param path_lab Training labels file
+ * @param opts     Training options
+ * @param step     Epochs already done
+ * @param resume   Checkpoint stream to resume from, positioned on the network (null for none)
+ * @return Return code
+**/
+static int session(char const* path_img, char const* path_lab, Helper::Options const& opts, nat_t step, ::std::istream* resume) {
+    ::std::string output = Helper::option(opts, "output", "quadratic");
+    if (output == "quadratic")
+        return session<Stage::Quadratic>(path_img, path_lab, opts, step, resume);
+    if (output == "softmax")
+        return session<Stage::Softmax>(path_img, path_lab, opts, step, resume);
+    ::std::cerr << "Unknown output stage '" << output << "'" << ::std::endl;
+    return 1;
+}
+
+/** Learning order handler.
+ * @param argc Number of arguments
+ * @param argv Arguments (at least 2)
+ * @return Return code
+**/
+int train(int argc, char** argv) {
+    if (argc < 4) { // Wrong number of parameters
+        ::std::cerr << "Usage: " << argv[0] << " " << argv[1] << " <training images> <training labels> [limit] [optimizer=plain|momentum|nesterov|adam|adamw] [eta=<rate>] [schedule=constant|step|cosine] [period=<epochs>] [factor=<step decay>] [output=quadratic|softmax] [input=symmetric|zero] [init=<raw network> [mask=1] | seed=<n>] [epochs=<max>] [pipeline=1 | stream=<chunk samples> [buffer=<samples>]] [online=1 < 'images and labels files, labels first to stream the images'...] [validate=<test images> validate-labels=<test labels> [interval=<epochs>] [subset=<images>]] [profile=1] [checkpoint=<path> [every=<epochs>]] [publish=<path>] | 'raw trained network'" << ::std::endl;
+        return 0;
+    }
+    Helper::Options opts;
+    for (int i = 4; i < argc; i++) {
+        if (i == 4 && !::std::strchr(argv[i], '=')) { // Positional limit
+            opts.push_back(::std::string("limit=") + argv[i]);
+        } else {
+            opts.push_back(argv[i]);
+        }
+    }
+    return session(argv[2], argv[3], opts, 0, null);
+}
+
+/** Resume order handler.
+ * @param argc Number of arguments
+ * @param argv Arguments (at least 2)
+ * @return Return code
+**/
+int resume(int argc, char** argv) {
+    if (argc != 5) { // Wrong number of parameters
+        ::std::cerr << "Usage: " << argv[0] << " " << argv[1] << " <training images> <training labels> <checkpoint> | 'raw trained network'" << ::std::endl;
+        return 0;
+    }
+    ::std::ifstream file(argv[4], ::std::ios::binary);
+    Helper::Options opts;
+    nat_t step;
+    { // Checkpoint header
+        if (!file || Helper::get<uint32_t>(file) != magic_ckpt) {
+            ::std::cerr << "'" << argv[4] << "' is not a checkpoint" << ::std::endl;
+            return 1;
+        }
+        uint32_t count = Helper::get<uint32_t>(file);
+        for (uint32_t i = 0; i < count && file; i++) {
+            ::std::string opt(Helper::get<uint32_t>(file), '\0');
+            file.read(&opt[0], opt.size());
+            opts.push_back(opt);
+        }
+        step = Helper::get<uint32_t>(file);
+        if (!file) {
+            ::std::cerr << "'" << argv[4] << "' is truncated" << ::std::endl;
+            return 1;
+        }
+    }
+    ::std::cerr << "Resuming from epoch " << step << "..." << ::std::endl;
+    return session(argv[2], argv[3], opts, step, &file);
+}
+
+/** Network whose wide layers are split between workers.
+ * @param Model Network type
+**/
+template<class Model> class Parallel final {
+private:
+    Model const& network; // Underlying network
+    Workers& workers; // Workers to use
+public:
+    /** Constructor.
+     * @param network Underlying network
+     * @param workers Workers to use
+    **/
+    Parallel(Model const& network, Workers& workers): network(network), workers(workers) {}
+public:
+    /** Compute the output vector of the network.
+     * @param Out    Output stage
+     * @param input  Input vector
+     * @param output Output vector
+    **/
+    template<class Out, nat_t input_dim, nat_t output_dim> void compute(Vector<input_dim> const& input, Vector<output_dim>& output) const {
+        network.template compute<Out>(input, output, workers);
+    }
+};
+
+/** Network served from a model store, switching to the latest published version between requests.
+**/
+class Served final {
+private:
+    ModelStore<Net>& store; // Model store
+    nat_t every; // Requests between two checks for a new version (0 for never)
+    mutable nat_t count; // Requests served
+public:
+    /** Bind constructor.
+     * @param store Model store, must outlive this object
+     * @param every Requests between two checks for a new version (0 for never)
+    **/
+    Served(ModelStore<Net>& store, nat_t every): store(store), every(every), count(0) {}
+public:
+    /** Compute the output vector of the version in use.
+     * @param Out    Output stage
+     * @param input  Input vector
+     * @param output Output vector
+    **/
+    template<class Out> void compute(Input const& input, Output& output) const {
+        if (every > 0 && ++count % every == 0) // Between two requests
+            store.refresh();
+        store.get().template compute<Out>(input, output);
+    }
+};
+
+/** Test a network on the testing set, report the accuracy and the time taken.
+ * @param network  Network to test
+ * @param softmax  Argmax over the softmax probabilities, not over saturated transfert outputs
+ * @param errordir Directory to which failed test image are output (null for no output)
+**/
+template<class Model> static void evaluate(Model const& network, bool softmax, char const* errordir) {
+    ::std::cerr << "Testing phase...";
+    ::std::cerr.flush();
+    nat_t success;
+    nat_t total;
+    auto start = ::std::chrono::steady_clock::now();
+    if (softmax) {
+        ::std::tie(success, total) = tests.test<Stage::Softmax>(network, errordir);
+    } else {
+        ::std::tie(success, total) = tests.test(network, errordir);
+    }
+    ::std::chrono::duration<double> elapsed = ::std::chrono::steady_clock::now() - start;
+    ::std::cerr << " " << success << "/" << total << " in " << elapsed.count() << " s" << ::std::endl;
+}
+
+/** Test a cascade on the testing set, calibrating it first if no threshold is given, report the escalation rate and throughput.
+ * @param Out       Output stage
+ * @param cascade   Cascade to test
+ * @param threshold Escalation threshold (null to calibrate it)
+ * @param tolerance Tolerated accuracy loss when calibrating, in ratio of the test elements
+**/
+template<class Out> static void escalate(Cascade<Student, Net>& cascade, char const* threshold, val_t tolerance) {
+    if (threshold) {
+        cascade.set(static_cast<val_t>(::std::atof(threshold)));
+    } else {
+        ::std::cerr << "Calibration phase... threshold " << tests.calibrate<Out>(cascade, tolerance) << ::std::endl;
+    }
+    nat_t full_success, cascade_success, total;
+    auto start = ::std::chrono::steady_clock::now();
+    ::std::tie(full_success, total) = tests.test<Out>(cascade.second());
+    ::std::chrono::duration<double> full_time = ::std::chrono::steady_clock::now() - start;
+    cascade.reset();
+    start = ::std::chrono::steady_clock::now();
+    ::std::tie(cascade_success, total) = tests.test<Out>(cascade);
+    ::std::chrono::duration<double> cascade_time = ::std::chrono::steady_clock::now() - start;
+    ::std::cerr << "Full network: " << full_success << "/" << total << ", " << total / full_time.count() << " requests/s" << ::std::endl;
+    ::std::cerr << "Cascade: " << cascade_success << "/" << total << ", " << total / cascade_time.count() << " requests/s, " << cascade.rate() * 100 << " % escalated (threshold " << cascade.get() << ")" << ::std::endl;
+}
+
+#ifndef MNIST_CONV
+/** Members of an ensemble computed one after the other, as without an ensemble.
+ * @param Comb Combination of the member outputs
+**/
+template<class Comb> class Members final {
+private:
+    Net const& first;  // First member
+    Net const& second; // Second member
+public:
+    /** Members constructor.
+     * @param first  First member, must outlive this object
+     * @param second Second member, must outlive this object
+    **/
+    Members(Net const& first, Net const& second): first(first), second(second) {}
+public:
+    /** Compute the combined output vector of the members.
+     * @param Out    Output stage
+     * @param input  Input vector
+     * @param output Combined output vector
+    **/
+    template<class Out> void compute(Input const& input, Output& output) const {
+        Output outputs[2];
+        first.template compute<Out>(input, outputs[0]);
+        second.template compute<Out>(input, outputs[1]);
+        Comb::reduce(outputs, 2, output);
+    }
+};
+
+/** Test an ensemble of the tested network and another one, report the accuracy of the members and the throughput of the ensemble against the members computed one after the other.
+ * @param Out   Output stage
+ * @param Comb  Combination of the member outputs
+ * @param other Second member
+**/
+template<class Out, class Comb> static void assemble(Net const& other) {
+    Allocated<Ensemble<Net, 2, Comb>, Allocator::HugePage> ensemble(transfert);
+    ensemble->set(0, *network);
+    ensemble->set(1, other);
+    nat_t first_success, second_success, separate_success, ensemble_success, total;
+    ::std::tie(first_success, total) = tests.test<Out>(*network);
+    ::std::tie(second_success, total) = tests.test<Out>(other);
+    auto start = ::std::chrono::steady_clock::now();
+    ::std::tie(separate_success, total) = tests.test<Out>(Members<Comb>(*network, other));
+    ::std::chrono::duration<double> separate_time = ::std::chrono::steady_clock::now() - start;
+    start = ::std::chrono::steady_clock::now();
+    ::std::tie(ensemble_success, total) = tests.test<Out>(*ensemble);
+    ::std::chrono::duration<double> ensemble_time = ::std::chrono::steady_clock::now() - start;
+    ::std::cerr << "Members: " << first_success << "/" << total << ", " << second_success << "/" << total << ::std::endl;
+    ::std::cerr << "One after the other: " << separate_success << "/" << total << ", " << total / separate_time.count() << " requests/s" << ::std::endl;
+    ::std::cerr << "Ensemble: " << ensemble_success << "/" << total << ", " << total / ensemble_time.count() << " requests/s" << ::std::endl;
+}
+#endif
+
+/** Test order handler.
+ * @param argc Number of arguments
+ * @param argv Arguments (at least 2)
+ * @return Return code
+**/
+int test(int argc, char** argv) {
+    if (argc < 4) { // Wrong number of parameters
+        ::std::cerr << "Usage: 'raw trained network' | " << argv[0] << " " << argv[1]  << " <test images> <test labels> [path/to/error/directory] [output=quadratic|softmax] [input=symmetric|zero] [student=1 | cascade=<raw distilled network> [threshold=<gap> | tolerance=<accuracy loss>] | ensemble=<raw trained network> [combine=average|vote] | model=<published network> [reload=<requests>] | sparse=1|4 | [threads=<workers>] [numa=1]] [timing=1] [profile=1]" << ::std::endl;
+        return 0;
+    }
+    Helper::Options opts;
+    char const* errordir = null;
+    for (int i = 4; i < argc; i++) {
+        if (::std::strchr(argv[i], '=')) {
+            opts.push_back(argv[i]);
+        } else {
+            errordir = argv[i];
+        }
+    }
+    ::std::string output = Helper::option(opts, "output", "quadratic");
+    if (output != "quadratic" && output != "softmax") {
+        ::std::cerr << "Unknown output stage '" << output << "'" << ::std::endl;
+        return 1;
+    }
+    ::std::string encoding = Helper::option(opts, "input", "symmetric");
+    if (encoding != "symmetric" && encoding != "zero") {
+        ::std::cerr << "Unknown input encoding '" << encoding << "'" << ::std::endl;
+        return 1;
+    }
+    ::std::string sparse = Helper::option(opts, "sparse", "0");
+    if (sparse != "0" && sparse != "1" && sparse != "4") {
+        ::std::cerr << "Unsupported block size '" << sparse << "'" << ::std::endl;
+        return 1;
+    }
+    nat_t threads = static_cast<nat_t>(::std::atol(Helper::option(opts, "threads", "0")));
+    bool numa = ::std::string(Helper::option(opts, "numa", "0")) == "1";
+    bool small = ::std::string(Helper::option(opts, "student", "0")) == "1";
+    if ((threads > 0 || numa) && sparse != "0") {
+        ::std::cerr << "Workers and replicas are only available for uncompressed networks" << ::std::endl;
+        return 1;
+    }
+    char const* cheap = Helper::option(opts, "cascade");
+    char const* mate  = Helper::option(opts, "ensemble");
+    if ((small || cheap || mate) && (threads > 0 || numa || sparse != "0")) {
+        ::std::cerr << "Distilled networks, cascades and ensembles are only tested as is" << ::std::endl;
+        return 1;
+    }
+    if (small && cheap) {
+        ::std::cerr << "A cascade escalates to the full network" << ::std::endl;
+        return 1;
+    }
+    if (mate && (small || cheap)) {
+        ::std::cerr << "An ensemble is made of full networks" << ::std::endl;
+        return 1;
+    }
+    char const* model = Helper::option(opts, "model");
+    if (model && (small || cheap || mate || threads > 0 || numa || sparse != "0")) {
+        ::std::cerr << "Published networks are only tested as is" << ::std::endl;
+        return 1;
+    }
+    ::std::string combine = Helper::option(opts, "combine", "average");
+    if (combine != "average" && combine != "vote") {
+        ::std::cerr << "Unknown combination '" << combine << "'" << ::std::endl;
+        return 1;
+    }
+#ifdef MNIST_CONV
+    if (mate || sparse != "0") {
+        ::std::cerr << "Ensembles and compressed networks are only available for fully-connected networks" << ::std::endl;
+        return 1;
+    }
+#endif
+    if (!init_transfert()) // Initialize transfert function
+        return 1;
+    { // Loading phase
+        ::std::cerr << "Loading testing files...";
+        ::std::cerr.flush();
+        try {
+            Loader test(argv[2], argv[3], encoding == "zero");
+            tests.load(test);
+        } catch (::std::runtime_error& err) {
+            ::std::cerr << " fail: " << err.what() << ::std::endl;
+            return 1;
+        }
+        ::std::cerr << " done." << ::std::endl;
+    }
+    if (!model) { // Input phase
+        Serializer::StreamInput si(::std::cin);
+        if (small) {
+            student->load(si);
+        } else {
+            network->load(si);
+        }
+    }
+    if (model) { // Serving phase
+        ::std::unique_ptr<ModelStore<Net>> store;
+        try {
+            store.reset(new ModelStore<Net>(model, transfert));
+        } catch (::std::runtime_error& err) {
+            ::std::cerr << err.what() << ::std::endl;
+            return 1;
+        }
+        evaluate(Served(*store, static_cast<nat_t>(::std::atol(Helper::option(opts, "reload", "0")))), output == "softmax", errordir);
+        ::std::cerr << "Served " << store->version() << " version(s) of '" << model << "'" << ::std::endl;
+    } else if (cheap) { // Cascade phase
+        ::std::ifstream file(cheap, ::std::ios::binary);
+        if (!file) {
+            ::std::cerr << "Unable to open '" << cheap << "' for reading" << ::std::endl;
+            return 1;
+        }
+        Serializer::StreamInput si(file);
+        student->load(si);
+        Cascade<Student, Net> cascade(*student, *network);
+        char const* threshold = Helper::option(opts, "threshold");
+        val_t tolerance = static_cast<val_t>(::std::atof(Helper::option(opts, "tolerance", "0")));
+        if (output == "softmax") {
+            escalate<Stage::Softmax>(cascade, threshold, tolerance);
+        } else {
+            escalate<Stage::Quadratic>(cascade, threshold, tolerance);
+        }
+#ifndef MNIST_CONV
+    } else if (mate) { // Ensemble phase
+        ::std::ifstream file(mate, ::std::ios::binary);
+        if (!file) {
+            ::std::cerr << "Unable to open '" << mate << "' for reading" << ::std::endl;
+            return 1;
+        }
+        Serializer::StreamInput si(file);
+        Allocated<Net, Allocator::HugePage> other(transfert);
+        other->load(si);
+        if (output == "softmax") {
+            if (combine == "vote") {
+                assemble<Stage::Softmax, Combine::Vote>(*other);
+            } else {
+                assemble<Stage::Softmax, Combine::Average>(*other);
+            }
+        } else {
+            if (combine == "vote") {
+                assemble<Stage::Quadratic, Combine::Vote>(*other);
+            } else {
+                assemble<Stage::Quadratic, Combine::Average>(*other);
+            }
+        }
+#endif
+    } else if (small) { // Testing phase
+        evaluate(*student, output == "softmax", errordir);
+#ifndef MNIST_CONV
+    } else if (sparse == "1") {
+        SparseNet<1> compressed(*network);
+        evaluate(compressed, output == "softmax", errordir);
+    } else if (sparse == "4") {
+        SparseNet<4> compressed(*network);
+        evaluate(compressed, output == "softmax", errordir);
+#endif
+    } else if (numa) {
+        Replicas<Net> replicas(*network, threads); // Up to 'threads' workers per node
+        replicas.enter(replicas.nodes().local());
+        ::std::cerr << "Replicated on " << replicas.size() << " node(s)" << ::std::endl;
+        evaluate(replicas, output == "softmax", errordir);
+    } else if (threads > 0) {
+        Workers workers(threads, 1); // Calling thread left unpinned, workers pinned from CPU 1
+        evaluate(Parallel<Net>(*network, workers), output == "softmax", errordir);
+    } else {
+        evaluate(*network, output == "softmax", errordir);
+    }
+    if (::std::string(Helper::option(opts, "timing", "0")) == "1") { // Latency report
+#ifdef STATICNET_TIMING
+        Timing::Registry::instance().dump(::std::cerr);
+#else
+        ::std::cerr << "Timing instrumentation not compiled in (build with TIMING=1)" << ::std::endl;
+#endif
+    }
+    profile(opts);
+    return 0;
+}
+
+/** Compute the soft targets of a batch of samples through the teacher network, the batch being split between the workers.
+ * @param Out        Output stage
+ * @param inputs     Input vectors
+ * @param outputs    Teacher outputs (output)
+ * @param size       Number of samples in the batch
+ * @param workers    Workers to use, the calling thread included
+ * @param workspaces Workspace of each part of the workers
+**/
+template<class Out> static void teach(Input const* inputs, Output* outputs, nat_t size, Workers& workers, Pool<Net::Space>& workspaces) {
+    workers.run([&](nat_t id, nat_t parts) {
+        auto range = Workers::range(size, id, parts);
+        for (nat_t i = range.first; i < range.second; i++)
+            network->template compute<Out>(inputs[i], outputs[i], workspaces[id]);
+    });
+}
+
+/** Time a network on the testing set.
+ * @param Out     Output stage
+ * @param network Network to test
+ * @param success Number of success (output)
+ * @param total   Number of test elements (output)
+ * @return Time taken, in seconds
+**/
+template<class Out, class Model> static double measure(Model const& network, nat_t& success, nat_t& total) {
+    auto start = ::std::chrono::steady_clock::now();
+    ::std::tie(success, total) = tests.test<Out>(network);
+    ::std::chrono::duration<double> elapsed = ::std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+/** Distillation session, the teacher network being loaded.
+ * @param Out      Output stage
+ * @param path_img Training images file
+ * @param path_lab Training labels file
+ * @param opts     Distillation options
+ * @return Return code
+**/
+template<class Out> static int distill(char const* path_img, char const* path_lab, Helper::Options const& opts) {
+    val_t tolerance = static_cast<val_t>(::std::atof(Helper::option(opts, "margin", "0.2")));
+    nat_t batch   = ::std::max<nat_t>(static_cast<nat_t>(::std::atol(Helper::option(opts, "batch", "256"))), 1);
+    nat_t threads = static_cast<nat_t>(::std::atol(Helper::option(opts, "threads", "0")));
+    nat_t epochs  = static_cast<nat_t>(::std::atol(Helper::option(opts, "epochs", "0")));
+    { // Soft targets phase
+        ::std::cerr << "Soft targets phase...";
+        ::std::cerr.flush();
+        try {
+            Loader train(path_img, path_lab, ::std::string(Helper::option(opts, "input", "symmetric")) == "zero");
+            ::std::vector<Input>  inputs(batch);
+            ::std::vector<Output> outputs(batch);
+            Workers workers(threads > 1 ? threads - 1 : 0); // Kept for every batch, the calling thread being one of the threads
+            Pool<Net::Space> workspaces; // One per part, the calling thread included
+            for (nat_t i = 0; i <= workers.size(); i++)
+                workspaces.emplace();
+            Output margin;
+            for (nat_t i = 0; i < output_dim; i++)
+                margin.set(i, tolerance);
+            for (bool cont = true; cont;) {
+                nat_t size = 0;
+                while (cont && size < batch) {
+                    nat_t label; // Ignored, the teacher answer being the target
+                    cont = train.feed(inputs[size++], label);
+                }
+                teach<Out>(inputs.data(), outputs.data(), size, workers, workspaces);
+                for (nat_t i = 0; i < size; i++)
+                    discipline.add(inputs[i], outputs[i], margin);
+            }
+        } catch (::std::runtime_error& err) {
+            ::std::cerr << " fail: " << err.what() << ::std::endl;
+            return 1;
+        }
+        ::std::cerr << " done." << ::std::endl;
+    }
+    char const* seed = Helper::option(opts, "seed");
+    if (seed) { // Randomize student, reproducibly
+        discipline.seed(::std::strtoull(seed, null, 10));
+        PhiloxRandomizer<std::ratio<1, 100>> randomizer(::std::strtoull(seed, null, 10));
+        student->randomize(randomizer);
+    } else {
+        UniformRandomizer<std::ratio<1, 100>> randomizer;
+        student->randomize(randomizer);
     }
     { // Learning phase
-        ::std::cerr << "Learning phase... epoch 0: ...";
+        Optimizer::Plain optim(Schedule(static_cast<val_t>(::std::atof(Helper::option(opts, "eta", "0.01")))));
+        ::std::cerr << "Distillation phase... epoch 0: ...";
         ::std::cerr.flush();
+        auto start = ::std::chrono::steady_clock::now();
         nat_t step = 0;
+        Allocated<Student::Space> workspace; // Intermediate vectors, for every epoch
         while (true) {
-            nat_t count = discipline.correct(network, eta, limit);
-            ::std::cerr << "\rLearning phase... epoch " << ++step << ": " << count << "          ";
-            if (count == 0)
+            optim.epoch(step);
+            nat_t count = discipline.correct<Out>(*student, *workspace, optim);
+            ::std::cerr << "\rDistillation phase... epoch " << ++step << ": " << count << "          ";
+            if (count == 0 || (epochs > 0 && step >= epochs))
                 break;
             ::std::cerr.flush();
             discipline.shuffle();
         }
-        ::std::cerr << "\rLearning phase... epoch " << step << " done.          " << ::std::endl;
+        ::std::chrono::duration<double> elapsed = ::std::chrono::steady_clock::now() - start;
+        ::std::cerr << "\rDistillation phase... epoch " << step << " done in " << elapsed.count() << " s.          " << ::std::endl;
+    }
+    { // Comparison phase
+        nat_t teacher_success;
+        nat_t student_success;
+        nat_t total;
+        double teacher_time = measure<Out>(*network, teacher_success, total);
+        double student_time = measure<Out>(*student, student_success, total);
+        ::std::cerr << "Teacher: " << teacher_success << "/" << total << " in " << teacher_time << " s" << ::std::endl;
+        ::std::cerr << "Student: " << student_success << "/" << total << " in " << student_time << " s" << ::std::endl;
+        ::std::cerr << "Speedup: " << teacher_time / student_time << "x, accuracy delta: " << (static_cast<double>(student_success) - static_cast<double>(teacher_success)) * 100 / total << " %" << ::std::endl;
     }
     { // Output phase
         Serializer::StreamOutput so(::std::cout);
-        network.store(so);
+        student->store(so);
     }
     return 0;
 }
 
-/** Test order handler.
+/** Distillation order handler.
  * @param argc Number of arguments
  * @param argv Arguments (at least 2)
  * @return Return code
 **/
-int test(int argc, char** argv) {
-    if (argc < 4 || argc > 5) { // Wrong number of parameters
-        ::std::cerr << "Usage: 'raw trained network' | " << argv[0] << " " << argv[1]  << " <test images> <test labels> [path/to/error/directory]" << ::std::endl;
+int distill(int argc, char** argv) {
+    if (argc < 6) { // Wrong number of parameters
+        ::std::cerr << "Usage: 'raw teacher network' | " << argv[0] << " " << argv[1] << " <training images> <training labels> <test images> <test labels> [output=quadratic|softmax] [input=symmetric|zero] [margin=<tolerance>] [eta=<rate>] [epochs=<max>] [seed=<n>] [batch=<samples>] [threads=<count>] | 'raw student network'" << ::std::endl;
         return 0;
     }
+    Helper::Options opts(argv + 6, argv + argc);
+    ::std::string output = Helper::option(opts, "output", "quadratic");
+    if (output != "quadratic" && output != "softmax") {
+        ::std::cerr << "Unknown output stage '" << output << "'" << ::std::endl;
+        return 1;
+    }
+    ::std::string encoding = Helper::option(opts, "input", "symmetric");
+    if (encoding != "symmetric" && encoding != "zero") {
+        ::std::cerr << "Unknown input encoding '" << encoding << "'" << ::std::endl;
+        return 1;
+    }
     if (!init_transfert()) // Initialize transfert function
         return 1;
     { // Loading phase
         ::std::cerr << "Loading testing files...";
         ::std::cerr.flush();
         try {
-            Loader test(argv[2], argv[3]);
+            Loader test(argv[4], argv[5], encoding == "zero");
             tests.load(test);
         } catch (::std::runtime_error& err) {
             ::std::cerr << " fail: " << err.what() << ::std::endl;
@@ -503,15 +1840,59 @@ int test(int argc, char** argv) {
     }
     { // Input phase
         Serializer::StreamInput si(::std::cin);
-        network.load(si);
+        network->load(si);
+    }
+    if (output == "softmax")
+        return distill<Stage::Softmax>(argv[2], argv[3], opts);
+    return distill<Stage::Quadratic>(argv[2], argv[3], opts);
+}
+
+/** Pruning order handler.
+ * @param argc Number of arguments
+ * @param argv Arguments (at least 2)
+ * @return Return code
+**/
+int prune(int argc, char** argv) {
+    if (argc < 3) { // Wrong number of parameters
+        ::std::cerr << "Usage: 'raw trained network' | " << argv[0] << " " << argv[1]  << " <density> [block=1|4] [scope=network|neuron] | 'raw pruned network'" << ::std::endl;
+        return 0;
+    }
+    Helper::Options opts(argv + 3, argv + argc);
+    val_t density = static_cast<val_t>(::std::atof(argv[2]));
+    ::std::string block = Helper::option(opts, "block", "1");
+    ::std::string scope = Helper::option(opts, "scope", "network");
+    if (density < 0 || density > 1) {
+        ::std::cerr << "Density must be in [0, 1]" << ::std::endl;
+        return 1;
+    }
+    if (block != "1" && block != "4") {
+        ::std::cerr << "Unsupported block size '" << block << "'" << ::std::endl;
+        return 1;
+    }
+    if (scope != "network" && scope != "neuron") {
+        ::std::cerr << "Unknown pruning scope '" << scope << "'" << ::std::endl;
+        return 1;
+    }
+    if (!init_transfert()) // Initialize transfert function
+        return 1;
+    { // Input phase
+        Serializer::StreamInput si(::std::cin);
+        network->load(si);
     }
-    { // Testing phase
-        ::std::cerr << "Testing phase...";
+    { // Pruning phase
+        ::std::cerr << "Pruning phase...";
         ::std::cerr.flush();
-        nat_t success;
-        nat_t total;
-        ::std::tie(success, total) = tests.test(network, (argc == 5 ? argv[4] : null));
-        ::std::cerr << " " << success << "/" << total << ::std::endl;
+        size_t kept;
+        if (block == "4") {
+            kept = Pruning::prune<4>(*network, density, scope == "neuron");
+        } else {
+            kept = Pruning::prune<1>(*network, density, scope == "neuron");
+        }
+        ::std::cerr << " " << kept << " blocks kept, density " << Pruning::density(*network) << ::std::endl;
+    }
+    { // Output phase
+        Serializer::StreamOutput so(::std::cout);
+        network->store(so);
     }
     return 0;
 }
@@ -539,7 +1920,7 @@ int plot(int argc, char** argv) {
 using Handler = int (*)(int, char**);
 
 // Map order to handler
-::std::unordered_map<::std::string, Handler> orders = { { "train", train }, { "test", test }, { "plot", plot } };
+::std::unordered_map<::std::string, Handler> orders = { { "train", train }, { "resume", resume }, { "test", test }, { "distill", distill }, { "prune", prune }, { "plot", plot } };
 
 // ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Orders ▔
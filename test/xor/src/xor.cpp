@@ -24,6 +24,7 @@
 // ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
 
 // External headers
+#include <chrono>
 #include <iostream>
 #include <cmath>
 
@@ -133,6 +134,24 @@ int main(int argc, char** argv) {
     }
     std::cout << "}" << std::endl;
 
+    std::cout << std::endl;
+    { // Latency (mean over many inferences, each one waiting for the previous output)
+        constexpr nat_t count = 1000000;
+        Vector<2> input;
+        Vector<1> output;
+        volatile val_t sink; // Keep the results alive
+        input = {-1, +1};
+        auto start = std::chrono::steady_clock::now();
+        for (nat_t i = 0; i < count; i++) {
+            network.compute(input, output);
+            input.set(0, output.get(0));
+            sink = output.get(0);
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        static_cast<void>(sink);
+        std::cout << "Latency: " << elapsed.count() / count << " ns/inference" << std::endl;
+    }
+
     return 0;
 }
 
@@ -0,0 +1,205 @@
+/**
+ * @file   check.cpp
+ * @author Sébastien Rouault <sebmsg@free.fr>
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Check a generated header against the network it was generated from, on a set of IDX images.
+**/
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▁ Declarations ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+// External headers
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Internal headers
+#include <staticnet.hpp>
+
+// Generated header
+#include <model.hpp>
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+using namespace StaticNet;
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+// Namespace and dimensions the header was generated with, set by the makefile
+#if !defined(MODEL_NAME) || !defined(MODEL_SHAPE)
+    #error Missing 'MODEL_NAME' or 'MODEL_SHAPE', build with 'make check'
+#endif
+namespace header = MODEL_NAME;
+
+/** Activation policy the header was generated for.
+**/
+using Policy = typename ::std::conditional<header::relu, Activation::Hidden<Activation::Relu, Activation::Table>, Activation::Uniform<Activation::Table>>::type;
+
+/** Reference network.
+**/
+using Net = BasicNetwork<Policy, MODEL_SHAPE>;
+
+// Reference network dimensions
+constexpr nat_t input_dim  = header::input_dim;
+constexpr nat_t output_dim = header::output_dim;
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Declarations ▔
+// ▁ Comparison ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+/** Read a big-endian 32-bit unsigned integer.
+ * @param file File to read from
+ * @return Integer value (0 on failure)
+**/
+static uint32_t read(::std::ifstream& file) {
+    uint8_t data[4] = { 0, 0, 0, 0 };
+    file.read(reinterpret_cast<char*>(data), sizeof(data));
+    return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+}
+
+/** Load the images of an IDX file as input vectors.
+ * @param path Images file
+ * @param zero Zero-background encoding, i.e. white pixels as 0 inputs
+ * @return Input vectors, empty on failure
+**/
+static ::std::vector<Vector<input_dim>> load(char const* path, bool zero) {
+    ::std::vector<Vector<input_dim>> inputs;
+    ::std::ifstream file(path, ::std::ios::binary);
+    uint32_t magic = read(file);
+    uint32_t count = read(file);
+    uint32_t size  = read(file) * read(file);
+    if (!file || magic != 0x00000803 || size != input_dim)
+        return inputs;
+    ::std::vector<uint8_t> pixels(input_dim);
+    inputs.resize(count);
+    for (Vector<input_dim>& input: inputs) {
+        if (!file.read(reinterpret_cast<char*>(pixels.data()), input_dim)) {
+            inputs.clear();
+            break;
+        }
+        for (nat_t i = 0; i < input_dim; i++)
+            input.set(i, zero ? static_cast<val_t>(pixels[i]) / 255 : static_cast<val_t>(pixels[i]) / 255 * 2 - 1);
+    }
+    return inputs;
+}
+
+/** Return the index of the largest output.
+ * @param output Output values
+ * @return Index of the largest one
+**/
+static nat_t argmax(val_t const* output) {
+    nat_t largest = 0;
+    for (nat_t i = 1; i < output_dim; i++)
+        if (output[i] > output[largest])
+            largest = i;
+    return largest;
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Comparison ▔
+// ▁ Entry point ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+/** Program entry point.
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @return Return code (non-zero if an output differs by more than the tolerance)
+**/
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 5) {
+        ::std::cerr << "Usage: " << (argc < 1 ? "check" : argv[0]) << " <network> <images> [tolerance] [zero]" << ::std::endl;
+        return 0;
+    }
+    val_t tolerance = (argc > 3 ? ::std::stof(argv[3]) : val_t(1e-5));
+    Transfert transfert;
+    val_t (*trans)(val_t) = (::std::strcmp(header::function, "tanh") == 0 ? static_cast<val_t (*)(val_t)>([](val_t x) -> val_t { return ::std::tanh(x); }) : static_cast<val_t (*)(val_t)>([](val_t x) -> val_t { return val_t(1) / (val_t(1) + ::std::exp(-x)); }));
+    if (!transfert.set(trans, -header::range, header::range, header::points)) {
+        ::std::cerr << "Precache of the transfert function failed" << ::std::endl;
+        return 1;
+    }
+    Allocated<Net, Allocator::HugePage> network(transfert);
+    { // Input phase
+        ::std::ifstream file(argv[1], ::std::ios::binary);
+        if (!file) {
+            ::std::cerr << "Unable to open '" << argv[1] << "' for reading" << ::std::endl;
+            return 1;
+        }
+        Serializer::StreamInput si(file);
+        network->load(si);
+    }
+    ::std::vector<Vector<input_dim>> inputs = load(argv[2], argc > 4 && ::std::string(argv[4]) == "zero");
+    if (inputs.empty()) {
+        ::std::cerr << "Unable to load images from '" << argv[2] << "'" << ::std::endl;
+        return 1;
+    }
+    nat_t count = static_cast<nat_t>(inputs.size());
+    ::std::vector<Vector<output_dim>> reference(count);
+    ::std::vector<val_t> generated(count * output_dim);
+    double time_reference;
+    double time_generated;
+    { // Reference outputs
+        auto start = ::std::chrono::steady_clock::now();
+        for (nat_t i = 0; i < count; i++)
+            network->compute(inputs[i], reference[i]);
+        ::std::chrono::duration<double> elapsed = ::std::chrono::steady_clock::now() - start;
+        time_reference = elapsed.count();
+    }
+    { // Generated outputs
+        auto start = ::std::chrono::steady_clock::now();
+        for (nat_t i = 0; i < count; i++)
+            header::compute(inputs[i].data(), generated.data() + i * output_dim);
+        ::std::chrono::duration<double> elapsed = ::std::chrono::steady_clock::now() - start;
+        time_generated = elapsed.count();
+    }
+    nat_t exact = 0; // Bit-for-bit identical outputs
+    nat_t agree = 0; // Identical decisions
+    val_t error = 0; // Maximal absolute difference
+    for (nat_t i = 0; i < count; i++) {
+        val_t const* output = generated.data() + i * output_dim;
+        bool same = true;
+        for (nat_t j = 0; j < output_dim; j++) {
+            val_t diff = ::std::fabs(reference[i].get(j) - output[j]);
+            if (diff > error)
+                error = diff;
+            if (::std::memcmp(&output[j], reference[i].data() + j, sizeof(val_t)) != 0)
+                same = false;
+        }
+        if (same)
+            exact++;
+        if (argmax(output) == argmax(reference[i].data()))
+            agree++;
+    }
+    ::std::cout << "Images:      " << count << ::std::endl;
+    ::std::cout << "Bit-exact:   " << exact << "/" << count << ::std::endl;
+    ::std::cout << "Same label:  " << agree << "/" << count << ::std::endl;
+    ::std::cout << "Max error:   " << error << " (tolerance " << tolerance << ")" << ::std::endl;
+    ::std::cout << "Network:     " << time_reference * 1e9 / count << " ns/inference" << ::std::endl;
+    ::std::cout << "Generated:   " << time_generated * 1e9 / count << " ns/inference" << ::std::endl;
+    return error <= tolerance ? 0 : 1;
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Entry point ▔
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
@@ -0,0 +1,298 @@
+/**
+ * @file   aot.cpp
+ * @author Sébastien Rouault <sebmsg@free.fr>
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Ahead-of-time compiler of a trained feed-forward neural network: bake its weights and transfert function table into a
+ * standalone C++ header, whose inference function has every dimension known at compile time.
+**/
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▁ Declarations ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+// External headers
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Internal headers
+#include <staticnet.hpp>
+
+// ―――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――――
+
+using namespace StaticNet;
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Declarations ▔
+// ▁ Code generation ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+namespace Aot {
+
+/** Print a float so that it is read back exactly.
+ * @param value Value to print
+ * @return Float literal
+**/
+::std::string literal(val_t value) {
+    char buffer[32];
+    ::std::snprintf(buffer, sizeof(buffer), "%.9g", static_cast<double>(value));
+    ::std::string text(buffer);
+    if (text.find_first_of(".e") == ::std::string::npos) // Integral value, keep it a floating-point literal
+        text += ".";
+    return text + "f";
+}
+
+/** Trained layer, loaded at runtime.
+**/
+class Layer final {
+    friend class Network;
+private:
+    nat_t const input_dim;  // Input dimension
+    nat_t const output_dim; // Output dimension
+    ::std::vector<val_t> weights; // Weights, row-major by neuron
+    ::std::vector<val_t> biases;  // Biases
+public:
+    /** Build an empty layer for the given dimensions.
+     * @param input_dim  Layer input dimension
+     * @param output_dim Layer output dimension
+    **/
+    Layer(nat_t input_dim, nat_t output_dim): input_dim(input_dim), output_dim(output_dim), weights(input_dim * output_dim), biases(output_dim) {}
+private:
+    /** Load layer weights, in the order of 'Neuron::store'.
+     * @param input Input serializer
+    **/
+    void load(Serializer::Input& input) {
+        for (nat_t i = 0; i < output_dim; i++) { // For each neuron of the current layer
+            for (nat_t j = 0; j < input_dim; j++) // For each weight of the current neuron
+                weights[i * input_dim + j] = input.load();
+            biases[i] = input.load();
+        }
+    }
+    /** Emit the weights and biases of the layer.
+     * @param out Output stream
+     * @param id  Layer id
+    **/
+    void emit(::std::ostream& out, nat_t id) const {
+        out << "alignas(64) constexpr float weights_" << id << "[" << output_dim << "][" << input_dim << "] = {" << ::std::endl;
+        for (nat_t i = 0; i < output_dim; i++) {
+            out << "    {";
+            for (nat_t j = 0; j < input_dim; j++)
+                out << (j % 8 == 0 ? "\n        " : " ") << literal(weights[i * input_dim + j]) << ",";
+            out << "\n    }," << ::std::endl;
+        }
+        out << "};" << ::std::endl;
+        out << "alignas(64) constexpr float biases_" << id << "[" << output_dim << "] = {";
+        for (nat_t i = 0; i < output_dim; i++)
+            out << (i % 8 == 0 ? "\n    " : " ") << literal(biases[i]) << ",";
+        out << "\n};" << ::std::endl << ::std::endl;
+    }
+};
+
+/** Trained feed-forward network, loaded at runtime and emitted as C++.
+**/
+class Network final {
+private:
+    ::std::vector<nat_t> dims; // Dimensions, input first
+    ::std::vector<Layer> layers; // Layers
+public:
+    /** Build a network from a dimension string.
+     * @param dim Dimensions string, null terminated
+    **/
+    Network(char const* dim) {
+        nat_t v = 0;
+        for (char const* cursor = dim;; cursor++) { // Split
+            char c = *cursor;
+            if (c == '\0' || c == '-') {
+                if (v == 0)
+                    throw ::std::runtime_error("Invalid dimensions string");
+                dims.push_back(v);
+                if (c == '\0')
+                    break;
+                v = 0;
+                continue;
+            }
+            if (c >= '0' && c <= '9') {
+                v = 10 * v + c - '0';
+                continue;
+            }
+            throw ::std::runtime_error("Invalid dimensions string");
+        }
+        if (dims.size() < 2)
+            throw ::std::runtime_error("At least one input and one output dimensions must be specified");
+        layers.reserve(dims.size() - 1);
+        for (nat_t i = 1; i < dims.size(); i++)
+            layers.push_back(Layer(dims[i - 1], dims[i]));
+    }
+public:
+    /** Load network weights.
+     * @param input Input serializer
+    **/
+    void load(Serializer::Input&& input) {
+        for (Layer& layer: layers)
+            layer.load(input);
+    }
+    /** Emit a standalone header computing the network.
+     * The transfert function table is built as 'Transfert::set' does, and interpolated as 'Transfert' does.
+     * @param out      Output stream
+     * @param name     Namespace of the generated code
+     * @param function Transfert function name ("sigmoid" or "tanh")
+     * @param range    Transfert function table input range, symmetric
+     * @param points   Transfert function table size
+     * @param relu     Whether the hidden layers use ReLU instead of the transfert function
+    **/
+    void emit(::std::ostream& out, ::std::string const& name, ::std::string const& function, val_t range, nat_t points, bool relu) const {
+        val_t (*trans)(val_t) = (function == "tanh" ? static_cast<val_t (*)(val_t)>([](val_t x) -> val_t { return ::std::tanh(x); }) : static_cast<val_t (*)(val_t)>([](val_t x) -> val_t { return val_t(1) / (val_t(1) + ::std::exp(-x)); }));
+        val_t const x_min = -range;
+        val_t const delta = range - x_min;
+        nat_t const count = points - 1;
+        val_t const scale = static_cast<val_t>(count) / delta;
+        val_t const prec1 = static_cast<val_t>(count);
+        ::std::string guard = name;
+        for (char& c: guard)
+            c = (c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c);
+        out << "// Generated by 'aot' from a trained ";
+        for (nat_t i = 0; i < dims.size(); i++)
+            out << (i > 0 ? "-" : "") << dims[i];
+        out << " network, do not edit" << ::std::endl;
+        out << "#pragma once" << ::std::endl << ::std::endl;
+        out << "#define " << guard << "_DIMS ";
+        for (nat_t i = 0; i < dims.size(); i++)
+            out << (i > 0 ? ", " : "") << dims[i];
+        out << ::std::endl << ::std::endl;
+        out << "namespace " << name << " {" << ::std::endl << ::std::endl;
+        out << "constexpr unsigned long input_dim  = " << dims.front() << ";" << ::std::endl;
+        out << "constexpr unsigned long output_dim = " << dims.back() << ";" << ::std::endl;
+        out << "constexpr char const* function = \"" << (function == "tanh" ? "tanh" : "sigmoid") << "\";" << ::std::endl;
+        out << "constexpr float range = " << literal(range) << ";" << ::std::endl;
+        out << "constexpr unsigned long points = " << points << ";" << ::std::endl;
+        out << "constexpr bool relu = " << (relu ? "true" : "false") << ";" << ::std::endl << ::std::endl;
+        { // Transfert function
+            out << "alignas(64) constexpr float table[" << points << "] = {";
+            for (nat_t i = 0; i < points; i++) {
+                val_t x = delta * static_cast<val_t>(i) / prec1 + x_min;
+                out << (i % 8 == 0 ? "\n    " : " ") << literal(trans(x)) << ",";
+            }
+            out << "\n};" << ::std::endl << ::std::endl;
+            out << "inline float transfert(float x) {" << ::std::endl;
+            out << "    if (x < " << literal(x_min) << ")" << ::std::endl;
+            out << "        return table[0];" << ::std::endl;
+            out << "    if (x >= " << literal(range) << ")" << ::std::endl;
+            out << "        return table[" << count << "];" << ::std::endl;
+            out << "    float t = (x - " << literal(x_min) << ") * " << literal(scale) << ";" << ::std::endl;
+            out << "    unsigned long i = static_cast<unsigned long>(t);" << ::std::endl;
+            out << "    if (i >= " << count << ")" << ::std::endl;
+            out << "        return table[" << count << "];" << ::std::endl;
+            out << "    return table[i] + (table[i + 1] - table[i]) * (t - static_cast<float>(i));" << ::std::endl;
+            out << "}" << ::std::endl << ::std::endl;
+        }
+        for (nat_t i = 0; i < layers.size(); i++) // Weights
+            layers[i].emit(out, i);
+        { // Inference function
+            out << "/** Compute the output of the network." << ::std::endl;
+            out << " * @param input  Input vector, of " << dims.front() << " values" << ::std::endl;
+            out << " * @param output Output vector, of " << dims.back() << " values" << ::std::endl;
+            out << "**/" << ::std::endl;
+            out << "inline void compute(float const* __restrict__ input, float* __restrict__ output) {" << ::std::endl;
+            for (nat_t i = 0; i < layers.size(); i++) {
+                Layer const& layer = layers[i];
+                bool last = (i + 1 == layers.size());
+                ::std::string in  = (i == 0 ? "input" : "layer_" + ::std::to_string(i - 1));
+                ::std::string dst = (last ? "output" : "layer_" + ::std::to_string(i));
+                if (!last)
+                    out << "    alignas(64) float " << dst << "[" << layer.output_dim << "];" << ::std::endl;
+                out << "    for (unsigned long i = 0; i < " << layer.output_dim << "; i++) {" << ::std::endl;
+                out << "        float sum = 0;" << ::std::endl;
+                out << "        for (unsigned long j = 0; j < " << layer.input_dim << "; j++)" << ::std::endl;
+                out << "            sum += weights_" << i << "[i][j] * " << in << "[j];" << ::std::endl;
+                out << "        sum += biases_" << i << "[i];" << ::std::endl;
+                if (relu && !last) {
+                    out << "        " << dst << "[i] = sum > 0 ? sum : 0;" << ::std::endl;
+                } else {
+                    out << "        " << dst << "[i] = transfert(sum);" << ::std::endl;
+                }
+                out << "    }" << ::std::endl;
+            }
+            out << "}" << ::std::endl << ::std::endl;
+        }
+        out << "}" << ::std::endl;
+    }
+};
+
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Code generation ▔
+// ▁ Entry point ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔
+
+/** Program entry point.
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @return Return code
+**/
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        ::std::cerr << "Usage: 'network' | " << (argc < 1 ? "aot" : argv[0]) << " <dimensions> [name=<namespace>] [function=sigmoid|tanh] [range=<table half range>] [points=<table size>] [hidden=table|relu] | 'C++ header'" << ::std::endl;
+        return 0;
+    }
+    ::std::string name = "model";
+    ::std::string function = "sigmoid";
+    val_t range  = 5;
+    nat_t points = 1001;
+    bool  relu   = false;
+    for (int i = 2; i < argc; i++) {
+        char const* value = ::std::strchr(argv[i], '=');
+        ::std::string key = (value ? ::std::string(argv[i], value - argv[i]) : ::std::string(argv[i]));
+        if (value)
+            value++;
+        if (key == "name" && value && *value) {
+            name = value;
+        } else if (key == "function" && value && (::std::string(value) == "sigmoid" || ::std::string(value) == "tanh")) {
+            function = value;
+        } else if (key == "range" && value) {
+            range = ::std::stof(value);
+        } else if (key == "points" && value) {
+            points = static_cast<nat_t>(::std::stoul(value));
+        } else if (key == "hidden" && value && (::std::string(value) == "table" || ::std::string(value) == "relu")) {
+            relu = ::std::string(value) == "relu";
+        } else {
+            ::std::cerr << "Invalid option '" << argv[i] << "'" << ::std::endl;
+            return 1;
+        }
+    }
+    if (range <= 0 || points < 2) {
+        ::std::cerr << "Invalid transfert function table" << ::std::endl;
+        return 1;
+    }
+    Aot::Network network(argv[1]); // Runtime-sized network
+    network.load(Serializer::StreamInput(::std::cin)); // Load a StaticNet network
+    if (!::std::cin) {
+        ::std::cerr << "Truncated network" << ::std::endl;
+        return 1;
+    }
+    network.emit(::std::cout, name, function, range, points, relu); // Output the header
+    return 0;
+}
+
+// ▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁▁
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔ Entry point ▔
+// ▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔▔